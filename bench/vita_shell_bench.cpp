@@ -0,0 +1,424 @@
+#define SDL_MAIN_HANDLED
+#include <SDL.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "data/file_util.h"
+#include "data/json.h"
+#include "data/library.h"
+#include "data/library_snapshot.h"
+#include "data/state.h"
+#include "scenes/home_screen.h"
+#include "scenes/index_screen.h"
+#include "scenes/notifications_screen.h"
+#include "scenes/overlays.h"
+#include "scenes/scene_stack.h"
+#include "ui/constants.h"
+#include "ui/headless.h"
+#include "ui/renderer.h"
+
+// Repeatable benchmarks for the data, state and render hot paths. Inputs are
+// generated deterministically into a scratch directory; results go to stdout
+// (or --out=<file>) as JSON so two builds can be compared mechanically.
+//
+//   vita_shell_bench [--filter=<substring>] [--out=<file>] [--min-time-ms=<ms>]
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using vita::data::ItemId;
+
+constexpr size_t kLibrarySizes[] = {1000, 10000, 100000};
+constexpr int kMinIterations = 5;
+constexpr int kMaxIterations = 100000;
+constexpr int kFrameMs = 16;
+
+struct Result {
+  std::string name;
+  size_t items = 0;
+  int iterations = 0;
+  double mean_ms = 0.0;
+  double p50_ms = 0.0;
+  double p99_ms = 0.0;
+  double min_ms = 0.0;
+  double max_ms = 0.0;
+};
+
+struct Options {
+  std::string filter;
+  std::filesystem::path out;
+  double min_time_ms = 250.0;
+};
+
+class Bench {
+ public:
+  explicit Bench(Options options) : options_(std::move(options)) {}
+
+  bool Enabled(std::string_view name) const {
+    return options_.filter.empty() || name.find(options_.filter) != std::string_view::npos;
+  }
+
+  // Runs `body` once to warm caches, then until both kMinIterations and the
+  // minimum time have been reached. `setup` runs before every iteration and
+  // is not timed.
+  void Run(const std::string &name, size_t items, const std::function<void()> &body,
+           const std::function<void()> &setup = {}) {
+    if (!Enabled(name)) {
+      return;
+    }
+    if (setup) {
+      setup();
+    }
+    body();
+    std::vector<double> samples;
+    double total = 0.0;
+    while (static_cast<int>(samples.size()) < kMaxIterations &&
+           (static_cast<int>(samples.size()) < kMinIterations || total < options_.min_time_ms)) {
+      if (setup) {
+        setup();
+      }
+      const auto start = Clock::now();
+      body();
+      const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+      samples.push_back(ms);
+      total += ms;
+    }
+    std::sort(samples.begin(), samples.end());
+    Result result;
+    result.name = name;
+    result.items = items;
+    result.iterations = static_cast<int>(samples.size());
+    result.mean_ms = total / samples.size();
+    result.p50_ms = samples[(samples.size() - 1) / 2];
+    result.p99_ms = samples[(samples.size() - 1) * 99 / 100];
+    result.min_ms = samples.front();
+    result.max_ms = samples.back();
+    std::fprintf(stderr, "%-32s %8zu items %7d iters  p50 %10.4f ms  p99 %10.4f ms\n",
+                 name.c_str(), items, result.iterations, result.p50_ms, result.p99_ms);
+    results_.push_back(std::move(result));
+  }
+
+  void Skip(const std::string &name, const std::string &reason) {
+    if (Enabled(name)) {
+      std::fprintf(stderr, "%-32s skipped: %s\n", name.c_str(), reason.c_str());
+      skipped_.emplace_back(name, reason);
+    }
+  }
+
+  bool Write() const {
+    vita::data::JsonWriter writer;
+    writer.BeginObject();
+    writer.WriteKey("build");
+    writer.BeginObject();
+    writer.WriteKey("compiler");
+    writer.WriteString(__VERSION__);
+    writer.WriteKey("optimized");
+#ifdef NDEBUG
+    writer.WriteBool(true);
+#else
+    writer.WriteBool(false);
+#endif
+    writer.EndObject();
+    writer.WriteKey("benchmarks");
+    writer.BeginArray();
+    for (const auto &result : results_) {
+      writer.BeginObject();
+      writer.WriteKey("name");
+      writer.WriteString(result.name);
+      writer.WriteKey("items");
+      writer.WriteNumber(static_cast<double>(result.items));
+      writer.WriteKey("iterations");
+      writer.WriteNumber(result.iterations);
+      writer.WriteKey("mean_ms");
+      writer.WriteNumber(result.mean_ms);
+      writer.WriteKey("p50_ms");
+      writer.WriteNumber(result.p50_ms);
+      writer.WriteKey("p99_ms");
+      writer.WriteNumber(result.p99_ms);
+      writer.WriteKey("min_ms");
+      writer.WriteNumber(result.min_ms);
+      writer.WriteKey("max_ms");
+      writer.WriteNumber(result.max_ms);
+      writer.EndObject();
+    }
+    writer.EndArray();
+    writer.WriteKey("skipped");
+    writer.BeginArray();
+    for (const auto &[name, reason] : skipped_) {
+      writer.BeginObject();
+      writer.WriteKey("name");
+      writer.WriteString(name);
+      writer.WriteKey("reason");
+      writer.WriteString(reason);
+      writer.EndObject();
+    }
+    writer.EndArray();
+    writer.EndObject();
+    if (options_.out.empty()) {
+      std::cout << writer.view() << "\n";
+      return true;
+    }
+    return vita::data::WriteFileAtomic(options_.out, writer.view());
+  }
+
+ private:
+  Options options_;
+  std::vector<Result> results_;
+  std::vector<std::pair<std::string, std::string>> skipped_;
+};
+
+// A library document shaped like data/library.json with `count` items.
+std::string GenerateLibrary(size_t count) {
+  vita::data::JsonWriter writer;
+  writer.BeginArray();
+  for (size_t index = 0; index < count; ++index) {
+    const std::string id = "bench.app" + std::to_string(index);
+    writer.BeginObject();
+    writer.WriteKey("id");
+    writer.WriteString(id);
+    writer.WriteKey("title");
+    writer.WriteString("Benchmark Title " + std::to_string((index * 7919) % count));
+    writer.WriteKey("desc");
+    writer.WriteString("Generated entry \"" + id + "\" for load and parse benchmarks");
+    writer.WriteKey("icon");
+    writer.WriteString("icons/" + id + ".png");
+    writer.WriteKey("hero");
+    writer.WriteString("heroes/" + id + ".png");
+    writer.WriteKey("cmd_linux");
+    writer.BeginArray();
+    writer.WriteString("echo");
+    writer.WriteString("Launching " + id);
+    writer.EndArray();
+    writer.WriteKey("cmd_windows");
+    writer.BeginArray();
+    writer.WriteString("cmd");
+    writer.WriteString("/c");
+    writer.WriteString("echo");
+    writer.WriteString("Launching " + id);
+    writer.EndArray();
+    writer.EndObject();
+  }
+  writer.EndArray();
+  return std::string(writer.view());
+}
+
+// Fills every page but the last, which holds folders taking the remaining
+// icons, so the layout is exactly at kMaxIcons (folder entries count too).
+vita::data::RuntimeState BuildFullState(const vita::data::Library &library) {
+  constexpr size_t kPerPage = vita::ui::kGridColumns * vita::ui::kGridRows;
+  constexpr size_t kFolders = 14;
+  const auto &items = library.items();
+  vita::data::RuntimeState state;
+  size_t next = 0;
+  const size_t page_icons = (vita::ui::kMaxPages - 1) * kPerPage;
+  while (next < page_icons) {
+    state.MoveEntry(items[next].item_id, next / kPerPage, next % kPerPage);
+    ++next;
+  }
+  std::vector<ItemId> folders;
+  for (size_t folder = 0; folder < kFolders; ++folder) {
+    folders.push_back(ItemId::InternFolder("Bench " + std::to_string(folder)));
+    state.AddFolder(folders.back());
+    state.MoveEntry(folders.back(), vita::ui::kMaxPages - 1, folder);
+  }
+  for (size_t index = 0; state.icon_count() < static_cast<size_t>(vita::ui::kMaxIcons);
+       ++next, ++index) {
+    state.AddToFolder(folders[index % kFolders], items[next].item_id);
+  }
+  for (size_t index = 0; index < 64; ++index) {
+    state.PushNotification({"Trophy " + std::to_string(index), items[index].item_id});
+    state.TouchLastPlayed(items[index].item_id, 1.7e9 + static_cast<double>(index));
+  }
+  state.journal.clear();
+  return state;
+}
+
+void BenchJson(Bench &bench, const std::filesystem::path &scratch) {
+  for (const size_t count : kLibrarySizes) {
+    const std::string suffix = "/" + std::to_string(count);
+    const std::string text = GenerateLibrary(count);
+    const std::filesystem::path path = scratch / ("library_" + std::to_string(count) + ".json");
+    vita::data::WriteFileAtomic(path, text);
+
+    bench.Run("json.parse" + suffix, count, [&] {
+      vita::data::JsonParser parser(text);
+      const vita::data::JsonValue value = parser.Parse();
+      (void)value;
+    });
+    bench.Run("json.parse_document" + suffix, count, [&] {
+      const vita::data::JsonDocument document = vita::data::JsonDocument::Parse(text);
+      (void)document;
+    });
+    if (bench.Enabled("json.stringify" + suffix)) {
+      vita::data::JsonParser parser(text);
+      const vita::data::JsonValue value = parser.Parse();
+      bench.Run("json.stringify" + suffix, count, [&] {
+        const std::string out = vita::data::JsonStringify(value);
+        (void)out;
+      });
+    }
+    // Load() writes the snapshot it did not find, so the cold case deletes
+    // it before every iteration and the warm case reads it back.
+    const std::filesystem::path snapshot = vita::data::LibrarySnapshotPath(path);
+    std::error_code error;
+    bench.Run(
+        "library.load_cold" + suffix, count, [&] { (void)vita::data::Library::Load(path); },
+        [&] { std::filesystem::remove(snapshot, error); });
+    bench.Run("library.load_warm" + suffix, count,
+              [&] { (void)vita::data::Library::Load(path); });
+    std::filesystem::remove(path, error);
+    std::filesystem::remove(snapshot, error);
+  }
+}
+
+void BenchState(Bench &bench, const vita::data::Library &library,
+                const std::filesystem::path &scratch) {
+  const vita::data::RuntimeState full = BuildFullState(library);
+  full.EnsureLimits(library.items().size());
+  const size_t icons = full.icon_count();
+
+  vita::data::StateStore store(scratch / "state.json");
+  bench.Run("state.save", icons, [&] { store.Save(full); });
+  store.Save(full);
+  bench.Run("state.load", icons, [&] { (void)store.Load(); });
+  bench.Run("state.round_trip", icons, [&] {
+    store.Save(full);
+    (void)store.Load();
+  });
+
+  // Each iteration replays the same pseudo-random mix of layout edits on a
+  // fresh copy of the full layout. Only icons that start on pages are
+  // picked, so no folder ever empties and the icon count stays put.
+  constexpr size_t kMutations = 1000;
+  std::vector<ItemId> page_icons;
+  std::vector<ItemId> folders;
+  for (const auto &page : full.pages) {
+    for (const ItemId entry : page) {
+      (entry.is_folder() ? folders : page_icons).push_back(entry);
+    }
+  }
+  vita::data::RuntimeState state;
+  bench.Run(
+      "state.mutations", kMutations,
+      [&] {
+        std::mt19937 random(42);
+        for (size_t index = 0; index < kMutations; ++index) {
+          const ItemId icon = page_icons[random() % page_icons.size()];
+          const ItemId folder = folders[random() % folders.size()];
+          switch (random() % 4) {
+            case 0:
+            case 1:
+              state.MoveEntry(icon, random() % (vita::ui::kMaxPages - 1), random() % 15);
+              break;
+            case 2:
+              state.AddToFolder(folder, icon);
+              break;
+            default:
+              state.MoveEntry(icon, random() % (vita::ui::kMaxPages - 1), 0);
+              break;
+          }
+        }
+        state.EnsureLimits(library.items().size());
+      },
+      [&] { state = full; });
+}
+
+void BenchScenes(Bench &bench, const vita::data::Library &library) {
+  const std::string name = "scene_stack.frame";
+  if (!bench.Enabled(name)) {
+    return;
+  }
+  if (SDL_Init(0) != 0) {
+    bench.Skip(name, SDL_GetError());
+    return;
+  }
+  try {
+    vita::ui::HeadlessTarget target;
+    vita::ui::Renderer render(target.renderer());
+    vita::data::RuntimeState state = BuildFullState(library);
+    vita::scenes::HomeScreen home(library, state);
+    vita::scenes::NotificationsScreen notifications(state);
+    vita::scenes::IndexScreen index_screen(library, state);
+    vita::scenes::QuickMenuOverlay quick_menu;
+    vita::scenes::SceneStack stack;
+    stack.Push(&home);
+    stack.Push(&notifications);
+    stack.Push(&index_screen);
+    stack.Push(&quick_menu);
+
+    auto frame = [&] {
+      stack.Update(kFrameMs);
+      stack.DamageAll();
+      render.BeginFrame();
+      stack.Render(render);
+      render.EndFrame();
+      SDL_RenderPresent(target.renderer());
+    };
+    bench.Run(name + "/home", 1, frame);
+    notifications.SetVisible(true);
+    bench.Run(name + "/notifications", 1, frame);
+    notifications.SetVisible(false);
+    index_screen.SetVisible(true);
+    bench.Run(name + "/index", 1, frame);
+    index_screen.SetVisible(false);
+    quick_menu.SetVisible(true);
+    bench.Run(name + "/quick_menu", 1, frame);
+  } catch (const std::exception &error) {
+    bench.Skip(name, error.what());
+  }
+  SDL_Quit();
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view arg = argv[i];
+    if (arg.substr(0, 9) == "--filter=") {
+      options.filter = std::string(arg.substr(9));
+    } else if (arg.substr(0, 6) == "--out=") {
+      options.out = std::string(arg.substr(6));
+    } else if (arg.substr(0, 14) == "--min-time-ms=") {
+      options.min_time_ms = std::atof(std::string(arg.substr(14)).c_str());
+    } else {
+      std::cerr << "Usage: vita_shell_bench [--filter=<substring>] [--out=<file>]"
+                   " [--min-time-ms=<ms>]\n";
+      return 1;
+    }
+  }
+
+  const std::filesystem::path scratch =
+      std::filesystem::temp_directory_path() / "vita_shell_bench";
+  std::error_code error;
+  std::filesystem::remove_all(scratch, error);
+  std::filesystem::create_directories(scratch);
+
+  Bench bench(options);
+  BenchJson(bench, scratch);
+
+  // State and scene benchmarks run against a library large enough to fill
+  // the layout to kMaxIcons.
+  const std::filesystem::path library_path = scratch / "library.json";
+  vita::data::WriteFileAtomic(library_path, GenerateLibrary(1000));
+  const vita::data::Library library = vita::data::Library::Load(library_path);
+  BenchState(bench, library, scratch);
+  BenchScenes(bench, library);
+
+  std::filesystem::remove_all(scratch, error);
+  if (!bench.Write()) {
+    std::cerr << "Failed to write " << options.out.string() << "\n";
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,31 @@
+# Minimal SDL2_image finder for environments without SDL2_imageConfig.cmake.
+# Allows users to set SDL2_IMAGE_DIR, SDL2_IMAGE_INCLUDE_DIR, and SDL2_IMAGE_LIBRARY.
+
+find_path(SDL2_IMAGE_INCLUDE_DIR
+  NAMES SDL_image.h
+  HINTS
+    ENV SDL2_IMAGE_INCLUDE_DIR
+    ${SDL2_IMAGE_DIR}
+  PATH_SUFFIXES include/SDL2 include
+)
+
+find_library(SDL2_IMAGE_LIBRARY
+  NAMES SDL2_image
+  HINTS
+    ENV SDL2_IMAGE_LIBRARY
+    ${SDL2_IMAGE_DIR}
+  PATH_SUFFIXES lib
+)
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(SDL2_image DEFAULT_MSG SDL2_IMAGE_INCLUDE_DIR SDL2_IMAGE_LIBRARY)
+
+if(SDL2_image_FOUND)
+  if(NOT TARGET SDL2_image::SDL2_image)
+    add_library(SDL2_image::SDL2_image UNKNOWN IMPORTED)
+    set_target_properties(SDL2_image::SDL2_image PROPERTIES
+      IMPORTED_LOCATION "${SDL2_IMAGE_LIBRARY}"
+      INTERFACE_INCLUDE_DIRECTORIES "${SDL2_IMAGE_INCLUDE_DIR}"
+    )
+  endif()
+endif()
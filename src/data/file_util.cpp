@@ -0,0 +1,129 @@
+#include "data/file_util.h"
+
+#include <cstring>
+#include <system_error>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace vita::data {
+
+uint64_t HashBytes(std::string_view bytes) {
+  constexpr uint64_t kMultiplier = 0xff51afd7ed558ccdull;
+  uint64_t hash = 0x9e3779b97f4a7c15ull ^ bytes.size();
+  size_t pos = 0;
+  for (; pos + 8 <= bytes.size(); pos += 8) {
+    uint64_t word = 0;
+    std::memcpy(&word, bytes.data() + pos, 8);
+    hash = (hash ^ word) * kMultiplier;
+    hash ^= hash >> 32;
+  }
+  if (pos < bytes.size()) {
+    uint64_t word = 0;
+    std::memcpy(&word, bytes.data() + pos, bytes.size() - pos);
+    hash = (hash ^ word) * kMultiplier;
+    hash ^= hash >> 32;
+  }
+  hash ^= hash >> 29;
+  return hash;
+}
+
+#ifdef _WIN32
+
+static bool WriteAll(int fd, std::string_view contents) {
+  return _write(fd, contents.data(), static_cast<unsigned>(contents.size())) ==
+         static_cast<int>(contents.size());
+}
+
+bool WriteFileAtomic(const std::filesystem::path &path, std::string_view contents) {
+  std::filesystem::path temp_path = path;
+  temp_path += ".tmp";
+  const int fd = _wopen(temp_path.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY,
+                        _S_IREAD | _S_IWRITE);
+  if (fd < 0) {
+    return false;
+  }
+  bool ok = WriteAll(fd, contents) && _commit(fd) == 0;
+  _close(fd);
+  std::error_code error;
+  if (ok) {
+    std::filesystem::rename(temp_path, path, error);
+  }
+  if (!ok || error) {
+    std::filesystem::remove(temp_path, error);
+    return false;
+  }
+  return true;
+}
+
+bool AppendFile(const std::filesystem::path &path, std::string_view contents) {
+  const int fd = _wopen(path.c_str(), _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY,
+                        _S_IREAD | _S_IWRITE);
+  if (fd < 0) {
+    return false;
+  }
+  const bool ok = WriteAll(fd, contents) && _commit(fd) == 0;
+  return (_close(fd) == 0) && ok;
+}
+
+#else
+
+static bool WriteAll(int fd, std::string_view contents) {
+  const char *data = contents.data();
+  size_t remaining = contents.size();
+  while (remaining > 0) {
+    const ssize_t written = ::write(fd, data, remaining);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    data += written;
+    remaining -= static_cast<size_t>(written);
+  }
+  return true;
+}
+
+bool WriteFileAtomic(const std::filesystem::path &path, std::string_view contents) {
+  std::filesystem::path temp_path = path;
+  temp_path += ".tmp";
+  const int fd = ::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    return false;
+  }
+  bool ok = WriteAll(fd, contents) && ::fsync(fd) == 0;
+  ok = (::close(fd) == 0) && ok;
+  if (!ok || ::rename(temp_path.c_str(), path.c_str()) != 0) {
+    ::unlink(temp_path.c_str());
+    return false;
+  }
+  const std::filesystem::path directory =
+      path.has_parent_path() ? path.parent_path() : std::filesystem::path(".");
+  const int dir_fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (dir_fd >= 0) {
+    ::fsync(dir_fd);
+    ::close(dir_fd);
+  }
+  return true;
+}
+
+bool AppendFile(const std::filesystem::path &path, std::string_view contents) {
+  const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    return false;
+  }
+  const bool ok = WriteAll(fd, contents) && ::fdatasync(fd) == 0;
+  return (::close(fd) == 0) && ok;
+}
+
+#endif
+
+}  // namespace vita::data
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
+namespace vita::data {
+
+// Fast non-cryptographic 64-bit hash used to detect changed file contents.
+uint64_t HashBytes(std::string_view bytes);
+
+// Replaces `path` with `contents` so that readers see either the old or the
+// new file, never a torn one: write a sibling temp file, fsync it, rename it
+// over `path`, then fsync the directory.
+bool WriteFileAtomic(const std::filesystem::path &path, std::string_view contents);
+
+// Appends `contents` to `path` (creating it) and syncs the data to disk.
+bool AppendFile(const std::filesystem::path &path, std::string_view contents);
+
+}  // namespace vita::data
@@ -0,0 +1,109 @@
+#include "data/file_watcher.h"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace vita::data {
+
+#ifdef __linux__
+
+FileWatcher::FileWatcher(const std::filesystem::path &path) {
+  std::error_code error;
+  std::filesystem::path directory = path;
+  if (!std::filesystem::is_directory(path, error)) {
+    directory = path.has_parent_path() ? path.parent_path() : std::filesystem::path(".");
+    file_name_ = path.filename().string();
+  }
+  inotify_fd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (inotify_fd_ < 0) {
+    return;
+  }
+  const uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE;
+  if (::inotify_add_watch(inotify_fd_, directory.c_str(), mask) < 0 ||
+      ::pipe2(wake_fds_, O_NONBLOCK | O_CLOEXEC) != 0) {
+    ::close(inotify_fd_);
+    inotify_fd_ = -1;
+  }
+}
+
+FileWatcher::~FileWatcher() {
+  if (inotify_fd_ >= 0) {
+    ::close(inotify_fd_);
+  }
+  for (int fd : wake_fds_) {
+    if (fd >= 0) {
+      ::close(fd);
+    }
+  }
+}
+
+bool FileWatcher::Matches(std::string_view name) const {
+  if (!file_name_.empty()) {
+    return name == file_name_;
+  }
+  constexpr std::string_view kExtension = ".json";
+  return name.size() > kExtension.size() &&
+         name.substr(name.size() - kExtension.size()) == kExtension;
+}
+
+bool FileWatcher::Wait(int timeout_ms) {
+  if (inotify_fd_ < 0) {
+    return false;
+  }
+  pollfd fds[2] = {{inotify_fd_, POLLIN, 0}, {wake_fds_[0], POLLIN, 0}};
+  if (::poll(fds, 2, timeout_ms) <= 0) {
+    return false;
+  }
+  if (fds[1].revents & POLLIN) {
+    char drain[64];
+    while (::read(wake_fds_[0], drain, sizeof(drain)) > 0) {
+    }
+    return false;
+  }
+  bool changed = false;
+  alignas(inotify_event) char buffer[4096];
+  while (true) {
+    const ssize_t length = ::read(inotify_fd_, buffer, sizeof(buffer));
+    if (length <= 0) {
+      break;
+    }
+    for (ssize_t offset = 0; offset < length;) {
+      const auto *event = reinterpret_cast<const inotify_event *>(buffer + offset);
+      if (event->len > 0 && Matches(event->name)) {
+        changed = true;
+      }
+      offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+    }
+  }
+  return changed;
+}
+
+void FileWatcher::Wake() {
+  if (wake_fds_[1] >= 0) {
+    const char byte = 1;
+    [[maybe_unused]] const ssize_t written = ::write(wake_fds_[1], &byte, 1);
+  }
+}
+
+#else
+
+FileWatcher::FileWatcher(const std::filesystem::path & /*path*/) {}
+
+FileWatcher::~FileWatcher() = default;
+
+bool FileWatcher::Matches(std::string_view /*name*/) const { return false; }
+
+bool FileWatcher::Wait(int /*timeout_ms*/) { return false; }
+
+void FileWatcher::Wake() {}
+
+#endif
+
+}  // namespace vita::data
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+namespace vita::data {
+
+// Blocking change notification for one file or for the *.json entries of one
+// directory, backed by inotify. A file is watched through its parent
+// directory so that editors which save by renaming a new file into place are
+// still seen. Elsewhere the watcher never opens and Wait() always times out.
+class FileWatcher {
+ public:
+  explicit FileWatcher(const std::filesystem::path &path);
+  ~FileWatcher();
+
+  FileWatcher(const FileWatcher &) = delete;
+  FileWatcher &operator=(const FileWatcher &) = delete;
+
+  bool is_open() const { return inotify_fd_ >= 0; }
+
+  // Blocks for up to `timeout_ms` (-1 waits forever) and returns true if a
+  // watched entry changed. Returns false on timeout or after Wake().
+  bool Wait(int timeout_ms);
+  // Interrupts a Wait() in progress from another thread.
+  void Wake();
+
+ private:
+  int inotify_fd_ = -1;
+  int wake_fds_[2] = {-1, -1};
+  std::string file_name_;  // empty when watching a directory
+
+  bool Matches(std::string_view name) const;
+};
+
+}  // namespace vita::data
@@ -0,0 +1,67 @@
+#include "data/item_id.h"
+
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace vita::data {
+
+namespace {
+
+// Names live in a deque so references handed out by str() stay valid while
+// other threads intern; the mutex only guards the index and the lookup map.
+struct IdTable {
+  std::mutex mutex;
+  std::deque<std::string> names;
+  std::unordered_map<std::string_view, uint32_t> index;
+};
+
+IdTable &Table() {
+  static IdTable table;
+  return table;
+}
+
+uint32_t InternName(std::string_view name) {
+  IdTable &table = Table();
+  std::lock_guard<std::mutex> lock(table.mutex);
+  auto iter = table.index.find(name);
+  if (iter != table.index.end()) {
+    return iter->second;
+  }
+  const uint32_t value = static_cast<uint32_t>(table.names.size());
+  if (value >= 0x7FFFFFFFu) {
+    throw std::runtime_error("Too many interned ids");
+  }
+  table.names.emplace_back(name);
+  table.index.emplace(table.names.back(), value);
+  return value;
+}
+
+}  // namespace
+
+ItemId ItemId::Intern(std::string_view name) {
+  if (name.empty()) {
+    return ItemId();
+  }
+  return ItemId(InternName(name));
+}
+
+ItemId ItemId::InternFolder(std::string_view name) {
+  if (name.empty()) {
+    return ItemId();
+  }
+  return ItemId(InternName(name) | kFolderBit);
+}
+
+const std::string &ItemId::str() const {
+  static const std::string kEmpty;
+  if (!valid()) {
+    return kEmpty;
+  }
+  IdTable &table = Table();
+  std::lock_guard<std::mutex> lock(table.mutex);
+  return table.names[value_ & ~kFolderBit];
+}
+
+}  // namespace vita::data
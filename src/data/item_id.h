@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace vita::data {
+
+// Process-wide interned handle for library item ids and folder names. It is
+// a 32-bit index into one shared table, so copies, hashing and comparison are
+// integer operations; the string is only needed at the JSON boundary. Folder
+// references carry a tag bit, so an item and a folder may share a name.
+class ItemId {
+ public:
+  ItemId() = default;
+
+  static ItemId Intern(std::string_view name);
+  static ItemId InternFolder(std::string_view name);
+
+  bool valid() const { return value_ != kInvalid; }
+  bool is_folder() const { return valid() && (value_ & kFolderBit) != 0; }
+  uint32_t value() const { return value_; }
+  const std::string &str() const;
+
+  bool operator==(ItemId other) const { return value_ == other.value_; }
+  bool operator!=(ItemId other) const { return value_ != other.value_; }
+  bool operator<(ItemId other) const { return value_ < other.value_; }
+
+ private:
+  static constexpr uint32_t kInvalid = 0xFFFFFFFFu;
+  static constexpr uint32_t kFolderBit = 0x80000000u;
+
+  explicit ItemId(uint32_t value) : value_(value) {}
+
+  uint32_t value_ = kInvalid;
+};
+
+}  // namespace vita::data
+
+template <>
+struct std::hash<vita::data::ItemId> {
+  size_t operator()(vita::data::ItemId id) const noexcept { return std::hash<uint32_t>()(id.value()); }
+};
@@ -1,15 +1,25 @@
 #include "data/json.h"
 
-#include <cctype>
-#include <sstream>
+#include <algorithm>
+#include <charconv>
+#include <cmath>
 #include <stdexcept>
 
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "data/json_scan.h"
+
 namespace vita::data {
 
 JsonValue::JsonValue() = default;
 JsonValue::JsonValue(bool value) : storage_(value) {}
 JsonValue::JsonValue(double value) : storage_(value) {}
-JsonValue::JsonValue(std::string value) : storage_(std::move(value)) {}
+JsonValue::JsonValue(std::string_view value, std::pmr::memory_resource *resource)
+    : storage_(std::pmr::string(value, resource)) {}
 JsonValue::JsonValue(Array value) : storage_(std::move(value)) {}
 JsonValue::JsonValue(Object value) : storage_(std::move(value)) {}
 
@@ -51,12 +61,19 @@ double JsonValue::AsNumber(double default_value) const {
 }
 
 std::string JsonValue::AsString(const std::string &default_value) const {
-  if (auto value = std::get_if<std::string>(&storage_)) {
-    return *value;
+  if (auto value = std::get_if<std::pmr::string>(&storage_)) {
+    return std::string(*value);
   }
   return default_value;
 }
 
+std::string_view JsonValue::AsStringView() const {
+  if (auto value = std::get_if<std::pmr::string>(&storage_)) {
+    return *value;
+  }
+  return {};
+}
+
 const JsonValue::Array &JsonValue::AsArray() const {
   static const Array kEmpty;
   if (auto value = std::get_if<Array>(&storage_)) {
@@ -73,257 +90,606 @@ const JsonValue::Object &JsonValue::AsObject() const {
   return kEmpty;
 }
 
-const JsonValue *JsonValue::Find(const std::string &key) const {
+const JsonValue *JsonValue::Find(std::string_view key) const {
   if (auto object = std::get_if<Object>(&storage_)) {
-    auto iter = object->find(key);
-    if (iter != object->end()) {
-      return &iter->second;
+    for (const auto &member : *object) {
+      if (member.first == key) {
+        return &member.second;
+      }
     }
   }
   return nullptr;
 }
 
-JsonParser::JsonParser(const std::string &input) : input_(input) {}
+JsonReader::JsonReader(std::string_view input) : input_(input) {}
 
-JsonValue JsonParser::Parse() {
-  SkipWhitespace();
-  JsonValue value = ParseValue();
+JsonValue::Type JsonReader::PeekType() {
   SkipWhitespace();
-  return value;
+  const char ch = Peek();
+  if (ch == '{') {
+    return JsonValue::Type::kObject;
+  }
+  if (ch == '[') {
+    return JsonValue::Type::kArray;
+  }
+  if (ch == '"') {
+    return JsonValue::Type::kString;
+  }
+  if (IsJsonDigit(ch) || ch == '-') {
+    return JsonValue::Type::kNumber;
+  }
+  if (ch == 't' || ch == 'f') {
+    return JsonValue::Type::kBool;
+  }
+  if (ch == 'n') {
+    return JsonValue::Type::kNull;
+  }
+  throw std::runtime_error("Unexpected JSON token");
 }
 
-void JsonParser::SkipWhitespace() {
-  while (pos_ < input_.size() && std::isspace(static_cast<unsigned char>(input_[pos_]))) {
-    ++pos_;
+bool JsonReader::BeginObject() {
+  if (PeekType() != JsonValue::Type::kObject) {
+    Skip();
+    return false;
   }
+  Match('{');
+  first_entry_ = true;
+  return true;
 }
 
-bool JsonParser::Match(char expected) {
-  if (pos_ < input_.size() && input_[pos_] == expected) {
-    ++pos_;
-    return true;
+// The key view points into the input or into scratch space and is only valid
+// until the next read.
+bool JsonReader::NextMember(std::string_view &key) {
+  if (!NextEntry('}')) {
+    return false;
   }
-  return false;
+  SkipWhitespace();
+  if (Peek() != '"') {
+    throw std::runtime_error("Expected string key");
+  }
+  key = ParseString();
+  SkipWhitespace();
+  if (!Match(':')) {
+    throw std::runtime_error("Expected ':' after key");
+  }
+  return true;
 }
 
-char JsonParser::Peek() const {
-  if (pos_ < input_.size()) {
-    return input_[pos_];
+bool JsonReader::BeginArray() {
+  if (PeekType() != JsonValue::Type::kArray) {
+    Skip();
+    return false;
   }
-  return '\0';
+  Match('[');
+  first_entry_ = true;
+  return true;
 }
 
-JsonValue JsonParser::ParseValue() {
+bool JsonReader::NextElement() {
+  return NextEntry(']');
+}
+
+bool JsonReader::NextEntry(char close) {
   SkipWhitespace();
-  char ch = Peek();
-  if (ch == '{') {
-    return ParseObject();
+  if (first_entry_) {
+    first_entry_ = false;
+    return !Match(close);
   }
-  if (ch == '[') {
-    return ParseArray();
+  if (Match(close)) {
+    return false;
   }
-  if (ch == '"') {
-    return JsonValue(ParseString());
+  if (!Match(',')) {
+    throw std::runtime_error(close == '}' ? "Expected ',' between object entries"
+                                          : "Expected ',' between array entries");
   }
-  if (std::isdigit(static_cast<unsigned char>(ch)) || ch == '-') {
-    return JsonValue(ParseNumber());
+  return true;
+}
+
+bool JsonReader::ReadBool(bool default_value) {
+  if (PeekType() != JsonValue::Type::kBool) {
+    Skip();
+    return default_value;
   }
   if (ParseLiteral("true")) {
-    return JsonValue(true);
+    return true;
   }
   if (ParseLiteral("false")) {
-    return JsonValue(false);
-  }
-  if (ParseLiteral("null")) {
-    return JsonValue();
+    return false;
   }
   throw std::runtime_error("Unexpected JSON token");
 }
 
-JsonValue JsonParser::ParseObject() {
-  if (!Match('{')) {
-    throw std::runtime_error("Expected '{'");
+double JsonReader::ReadNumber(double default_value) {
+  if (PeekType() != JsonValue::Type::kNumber) {
+    Skip();
+    return default_value;
   }
-  JsonValue::Object result;
-  SkipWhitespace();
-  if (Match('}')) {
-    return JsonValue(result);
+  return ParseNumber();
+}
+
+std::string JsonReader::ReadString(const std::string &default_value) {
+  if (PeekType() != JsonValue::Type::kString) {
+    Skip();
+    return default_value;
   }
-  while (true) {
-    SkipWhitespace();
-    if (Peek() != '"') {
-      throw std::runtime_error("Expected string key");
+  return std::string(ParseString());
+}
+
+std::string_view JsonReader::ReadStringView() {
+  if (PeekType() != JsonValue::Type::kString) {
+    Skip();
+    return {};
+  }
+  return ParseString();
+}
+
+void JsonReader::Skip() {
+  switch (PeekType()) {
+    case JsonValue::Type::kObject: {
+      BeginObject();
+      std::string_view key;
+      while (NextMember(key)) {
+        Skip();
+      }
+      return;
     }
-    std::string key = ParseString();
-    SkipWhitespace();
-    if (!Match(':')) {
-      throw std::runtime_error("Expected ':' after key");
+    case JsonValue::Type::kArray:
+      BeginArray();
+      while (NextElement()) {
+        Skip();
+      }
+      return;
+    case JsonValue::Type::kString:
+      SkipString();
+      return;
+    case JsonValue::Type::kNumber:
+      ScanNumber();
+      return;
+    case JsonValue::Type::kBool:
+      ReadBool();
+      return;
+    case JsonValue::Type::kNull:
+      if (!ParseLiteral("null")) {
+        throw std::runtime_error("Unexpected JSON token");
+      }
+      return;
+  }
+}
+
+void JsonReader::SkipWhitespace() {
+  if (pos_ < input_.size() && IsJsonWhitespace(input_[pos_])) {
+    pos_ = ScanWhitespace(input_.data(), pos_ + 1, input_.size());
+  }
+}
+
+bool JsonReader::Match(char expected) {
+  if (pos_ < input_.size() && input_[pos_] == expected) {
+    ++pos_;
+    return true;
+  }
+  return false;
+}
+
+char JsonReader::Peek() const {
+  if (pos_ < input_.size()) {
+    return input_[pos_];
+  }
+  return '\0';
+}
+
+// Strings without escapes are returned as a view into the input; only
+// escaped strings are decoded into scratch space. Plain runs between escapes
+// are found with the scan kernels and copied in bulk.
+std::string_view JsonReader::ParseString() {
+  if (!Match('"')) {
+    throw std::runtime_error("Expected string opening quote");
+  }
+  const char *data = input_.data();
+  const size_t size = input_.size();
+  const size_t start = pos_;
+  pos_ = ScanToQuoteOrBackslash(data, pos_, size);
+  if (pos_ < size && data[pos_] == '"') {
+    ++pos_;
+    return input_.substr(start, pos_ - 1 - start);
+  }
+  scratch_.assign(data + start, pos_ - start);
+  while (pos_ < size) {
+    char ch = data[pos_++];
+    if (ch == '"') {
+      break;
     }
-    SkipWhitespace();
-    JsonValue value = ParseValue();
-    result.emplace(std::move(key), std::move(value));
-    SkipWhitespace();
-    if (Match('}')) {
+    if (pos_ >= size) {
       break;
     }
-    if (!Match(',')) {
-      throw std::runtime_error("Expected ',' between object entries");
+    char escaped = data[pos_++];
+    switch (escaped) {
+      case '"':
+      case '\\':
+      case '/':
+        scratch_.push_back(escaped);
+        break;
+      case 'b':
+        scratch_.push_back('\b');
+        break;
+      case 'f':
+        scratch_.push_back('\f');
+        break;
+      case 'n':
+        scratch_.push_back('\n');
+        break;
+      case 'r':
+        scratch_.push_back('\r');
+        break;
+      case 't':
+        scratch_.push_back('\t');
+        break;
+      case 'u':
+        AppendEscapedUnicode();
+        break;
+      default:
+        scratch_.push_back(escaped);
+        break;
     }
+    const size_t run = pos_;
+    pos_ = ScanToQuoteOrBackslash(data, pos_, size);
+    scratch_.append(data + run, pos_ - run);
   }
-  return JsonValue(result);
+  return scratch_;
 }
 
-JsonValue JsonParser::ParseArray() {
-  if (!Match('[')) {
-    throw std::runtime_error("Expected '['");
+static int ParseHex4(std::string_view input, size_t pos) {
+  if (pos + 4 > input.size()) {
+    return -1;
   }
-  JsonValue::Array result;
-  SkipWhitespace();
-  if (Match(']')) {
-    return JsonValue(result);
+  int value = 0;
+  const auto result = std::from_chars(input.data() + pos, input.data() + pos + 4, value, 16);
+  if (result.ec != std::errc() || result.ptr != input.data() + pos + 4) {
+    return -1;
   }
-  while (true) {
-    SkipWhitespace();
-    result.push_back(ParseValue());
-    SkipWhitespace();
-    if (Match(']')) {
-      break;
-    }
-    if (!Match(',')) {
-      throw std::runtime_error("Expected ',' between array entries");
+  return value;
+}
+
+// Decodes the four hex digits after "\u" (and a following low surrogate,
+// if any) and appends the code point to scratch space as UTF-8.
+void JsonReader::AppendEscapedUnicode() {
+  int code = ParseHex4(input_, pos_);
+  if (code < 0) {
+    throw std::runtime_error("Invalid \\u escape");
+  }
+  pos_ += 4;
+  if (code >= 0xD800 && code <= 0xDBFF && input_.substr(pos_, 2) == "\\u") {
+    const int low = ParseHex4(input_, pos_ + 2);
+    if (low >= 0xDC00 && low <= 0xDFFF) {
+      code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+      pos_ += 6;
     }
   }
-  return JsonValue(result);
+  if (code < 0x80) {
+    scratch_.push_back(static_cast<char>(code));
+  } else if (code < 0x800) {
+    scratch_.push_back(static_cast<char>(0xC0 | (code >> 6)));
+    scratch_.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+  } else if (code < 0x10000) {
+    scratch_.push_back(static_cast<char>(0xE0 | (code >> 12)));
+    scratch_.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+    scratch_.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+  } else {
+    scratch_.push_back(static_cast<char>(0xF0 | (code >> 18)));
+    scratch_.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+    scratch_.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+    scratch_.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+  }
 }
 
-std::string JsonParser::ParseString() {
+void JsonReader::SkipString() {
   if (!Match('"')) {
     throw std::runtime_error("Expected string opening quote");
   }
-  std::string result;
-  while (pos_ < input_.size()) {
-    char ch = input_[pos_++];
-    if (ch == '"') {
-      break;
+  const size_t size = input_.size();
+  while (true) {
+    pos_ = ScanToQuoteOrBackslash(input_.data(), pos_, size);
+    if (pos_ >= size) {
+      return;
     }
-    if (ch == '\\') {
-      if (pos_ >= input_.size()) {
-        break;
-      }
-      char escaped = input_[pos_++];
-      switch (escaped) {
-        case '"':
-        case '\\':
-        case '/':
-          result.push_back(escaped);
-          break;
-        case 'b':
-          result.push_back('\b');
-          break;
-        case 'f':
-          result.push_back('\f');
-          break;
-        case 'n':
-          result.push_back('\n');
-          break;
-        case 'r':
-          result.push_back('\r');
-          break;
-        case 't':
-          result.push_back('\t');
-          break;
-        default:
-          result.push_back(escaped);
-          break;
-      }
-      continue;
+    if (input_[pos_++] == '"') {
+      return;
     }
-    result.push_back(ch);
+    pos_ = std::min(pos_ + 1, size);
   }
-  return result;
 }
 
-double JsonParser::ParseNumber() {
-  size_t start = pos_;
-  if (Peek() == '-') {
-    ++pos_;
+size_t JsonReader::ScanNumber() {
+  const char *data = input_.data();
+  const size_t size = input_.size();
+  const size_t start = pos_;
+  Match('-');
+  size_t digits = pos_;
+  pos_ = ScanDigits(data, pos_, size);
+  if (pos_ == digits) {
+    throw std::runtime_error("Invalid JSON number");
   }
-  while (pos_ < input_.size() && std::isdigit(static_cast<unsigned char>(input_[pos_]))) {
-    ++pos_;
+  if (Match('.')) {
+    pos_ = ScanDigits(data, pos_, size);
   }
-  if (Peek() == '.') {
+  if (Peek() == 'e' || Peek() == 'E') {
     ++pos_;
-    while (pos_ < input_.size() && std::isdigit(static_cast<unsigned char>(input_[pos_]))) {
+    if (Peek() == '+' || Peek() == '-') {
       ++pos_;
     }
+    digits = pos_;
+    pos_ = ScanDigits(data, pos_, size);
+    if (pos_ == digits) {
+      throw std::runtime_error("Invalid JSON number");
+    }
+  }
+  return start;
+}
+
+double JsonReader::ParseNumber() {
+  const char *first = input_.data() + ScanNumber();
+  const char *last = input_.data() + pos_;
+  double value = 0.0;
+  const auto result = std::from_chars(first, last, value);
+  if (result.ec != std::errc() || result.ptr != last) {
+    throw std::runtime_error("Invalid JSON number");
   }
-  std::string token = input_.substr(start, pos_ - start);
-  return std::stod(token);
+  return value;
 }
 
-bool JsonParser::ParseLiteral(const std::string &literal) {
-  if (input_.compare(pos_, literal.size(), literal) == 0) {
+bool JsonReader::ParseLiteral(std::string_view literal) {
+  if (input_.substr(pos_, literal.size()) == literal) {
     pos_ += literal.size();
     return true;
   }
   return false;
 }
 
-static void JsonStringifyValue(const JsonValue &value, std::ostringstream &out) {
+JsonParser::JsonParser(std::string_view input, std::pmr::memory_resource *resource)
+    : reader_(input), resource_(resource) {}
+
+JsonValue JsonParser::Parse() {
+  return ParseValue();
+}
+
+JsonValue JsonParser::ParseValue() {
+  switch (reader_.PeekType()) {
+    case JsonValue::Type::kObject:
+      return ParseObject();
+    case JsonValue::Type::kArray:
+      return ParseArray();
+    case JsonValue::Type::kString:
+      return JsonValue(reader_.ReadStringView(), resource_);
+    case JsonValue::Type::kNumber:
+      return JsonValue(reader_.ReadNumber());
+    case JsonValue::Type::kBool:
+      return JsonValue(reader_.ReadBool());
+    case JsonValue::Type::kNull:
+      reader_.Skip();
+      return JsonValue();
+  }
+  return JsonValue();
+}
+
+JsonValue JsonParser::ParseObject() {
+  JsonValue::Object result(resource_);
+  reader_.BeginObject();
+  std::string_view key;
+  while (reader_.NextMember(key)) {
+    std::pmr::string name(key, resource_);
+    result.emplace_back(std::move(name), ParseValue());
+  }
+  return JsonValue(std::move(result));
+}
+
+JsonValue JsonParser::ParseArray() {
+  JsonValue::Array result(resource_);
+  reader_.BeginArray();
+  while (reader_.NextElement()) {
+    result.push_back(ParseValue());
+  }
+  return JsonValue(std::move(result));
+}
+
+JsonDocument JsonDocument::Parse(std::string_view input) {
+  JsonDocument document;
+  document.arena_ = std::make_unique<std::pmr::monotonic_buffer_resource>(
+      std::max<size_t>(input.size(), 4096));
+  std::pmr::polymorphic_allocator<JsonValue> allocator(document.arena_.get());
+  JsonValue *root = allocator.allocate(1);
+  JsonParser parser(input, document.arena_.get());
+  allocator.construct(root, parser.Parse());
+  document.root_ = root;
+  return document;
+}
+
+JsonWriter::JsonWriter() = default;
+
+JsonWriter::JsonWriter(int fd) : fd_(fd) {
+  buffer_.reserve(kFlushBytes);
+}
+
+void JsonWriter::BeginObject() {
+  BeginValue();
+  buffer_.push_back('{');
+  needs_comma_ = false;
+}
+
+void JsonWriter::EndObject() {
+  buffer_.push_back('}');
+  needs_comma_ = true;
+  MaybeFlush();
+}
+
+void JsonWriter::BeginArray() {
+  BeginValue();
+  buffer_.push_back('[');
+  needs_comma_ = false;
+}
+
+void JsonWriter::EndArray() {
+  buffer_.push_back(']');
+  needs_comma_ = true;
+  MaybeFlush();
+}
+
+void JsonWriter::WriteKey(std::string_view key) {
+  BeginValue();
+  AppendEscaped(key);
+  buffer_.push_back(':');
+  needs_comma_ = false;
+}
+
+void JsonWriter::WriteString(std::string_view value) {
+  BeginValue();
+  AppendEscaped(value);
+  needs_comma_ = true;
+}
+
+void JsonWriter::WriteNumber(double value) {
+  BeginValue();
+  if (!std::isfinite(value)) {
+    buffer_.append("null");
+  } else {
+    char digits[32];
+    const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    buffer_.append(digits, result.ptr);
+  }
+  needs_comma_ = true;
+}
+
+void JsonWriter::WriteBool(bool value) {
+  BeginValue();
+  buffer_.append(value ? "true" : "false");
+  needs_comma_ = true;
+}
+
+void JsonWriter::WriteNull() {
+  BeginValue();
+  buffer_.append("null");
+  needs_comma_ = true;
+}
+
+void JsonWriter::WriteValue(const JsonValue &value) {
   switch (value.type()) {
     case JsonValue::Type::kNull:
-      out << "null";
+      WriteNull();
       return;
     case JsonValue::Type::kBool:
-      out << (value.AsBool() ? "true" : "false");
+      WriteBool(value.AsBool());
       return;
     case JsonValue::Type::kNumber:
-      out << value.AsNumber();
+      WriteNumber(value.AsNumber());
+      return;
+    case JsonValue::Type::kString:
+      WriteString(value.AsStringView());
       return;
-    case JsonValue::Type::kString: {
-      out << '"';
-      for (char ch : value.AsString()) {
-        if (ch == '"' || ch == '\\') {
-          out << '\\';
-        }
-        out << ch;
+    case JsonValue::Type::kArray:
+      BeginArray();
+      for (const auto &entry : value.AsArray()) {
+        WriteValue(entry);
       }
-      out << '"';
+      EndArray();
       return;
-    }
-    case JsonValue::Type::kArray: {
-      out << '[';
-      const auto &array = value.AsArray();
-      for (size_t i = 0; i < array.size(); ++i) {
-        JsonStringifyValue(array[i], out);
-        if (i + 1 < array.size()) {
-          out << ',';
-        }
+    case JsonValue::Type::kObject:
+      BeginObject();
+      for (const auto &member : value.AsObject()) {
+        WriteKey(member.first);
+        WriteValue(member.second);
       }
-      out << ']';
+      EndObject();
       return;
+  }
+}
+
+bool JsonWriter::Flush() {
+  if (fd_ < 0 || !ok_) {
+    return ok_;
+  }
+  const char *data = buffer_.data();
+  size_t remaining = buffer_.size();
+  while (remaining > 0) {
+#ifdef _WIN32
+    const auto written = _write(fd_, data, static_cast<unsigned>(remaining));
+#else
+    const auto written = ::write(fd_, data, remaining);
+#endif
+    if (written < 0) {
+      ok_ = false;
+      break;
     }
-    case JsonValue::Type::kObject: {
-      out << '{';
-      const auto &obj = value.AsObject();
-      size_t index = 0;
-      for (const auto &entry : obj) {
-        out << '"' << entry.first << '"' << ':';
-        JsonStringifyValue(entry.second, out);
-        if (++index < obj.size()) {
-          out << ',';
-        }
+    data += written;
+    remaining -= static_cast<size_t>(written);
+  }
+  buffer_.clear();
+  return ok_;
+}
+
+void JsonWriter::Clear() {
+  buffer_.clear();
+  needs_comma_ = false;
+  ok_ = true;
+}
+
+void JsonWriter::BeginValue() {
+  if (needs_comma_) {
+    buffer_.push_back(',');
+  }
+}
+
+void JsonWriter::AppendEscaped(std::string_view value) {
+  static constexpr char kHex[] = "0123456789abcdef";
+  buffer_.push_back('"');
+  size_t pos = 0;
+  while (pos < value.size()) {
+    const size_t run = pos;
+    pos = ScanToEscape(value.data(), pos, value.size());
+    buffer_.append(value.data() + run, pos - run);
+    if (pos >= value.size()) {
+      break;
+    }
+    const unsigned char ch = static_cast<unsigned char>(value[pos++]);
+    switch (ch) {
+      case '"':
+        buffer_.append("\\\"");
+        break;
+      case '\\':
+        buffer_.append("\\\\");
+        break;
+      case '\b':
+        buffer_.append("\\b");
+        break;
+      case '\f':
+        buffer_.append("\\f");
+        break;
+      case '\n':
+        buffer_.append("\\n");
+        break;
+      case '\r':
+        buffer_.append("\\r");
+        break;
+      case '\t':
+        buffer_.append("\\t");
+        break;
+      default: {
+        const char escaped[] = {'\\', 'u', '0', '0', kHex[ch >> 4], kHex[ch & 0xF]};
+        buffer_.append(escaped, sizeof(escaped));
+        break;
       }
-      out << '}';
-      return;
     }
   }
+  buffer_.push_back('"');
+}
+
+void JsonWriter::MaybeFlush() {
+  if (fd_ >= 0 && buffer_.size() >= kFlushBytes) {
+    Flush();
+  }
 }
 
 std::string JsonStringify(const JsonValue &value) {
-  std::ostringstream out;
-  JsonStringifyValue(value, out);
-  return out.str();
+  JsonWriter writer;
+  writer.WriteValue(value);
+  return std::string(writer.view());
 }
 
 }  // namespace vita::data
@@ -1,7 +1,10 @@
 #pragma once
 
+#include <memory>
+#include <memory_resource>
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -9,8 +12,12 @@ namespace vita::data {
 
 class JsonValue {
  public:
-  using Array = std::vector<JsonValue>;
-  using Object = std::unordered_map<std::string, JsonValue>;
+  // Containers take a memory resource so a JsonDocument can place every node
+  // and string in its arena. Objects are flat member lists in insertion
+  // order; the files we read rarely have more than a handful of keys.
+  using Array = std::pmr::vector<JsonValue>;
+  using Member = std::pair<std::pmr::string, JsonValue>;
+  using Object = std::pmr::vector<Member>;
 
   enum class Type {
     kNull,
@@ -24,7 +31,8 @@ class JsonValue {
   JsonValue();
   explicit JsonValue(bool value);
   explicit JsonValue(double value);
-  explicit JsonValue(std::string value);
+  explicit JsonValue(std::string_view value,
+                     std::pmr::memory_resource *resource = std::pmr::get_default_resource());
   explicit JsonValue(Array value);
   explicit JsonValue(Object value);
 
@@ -33,34 +41,124 @@ class JsonValue {
   bool AsBool(bool default_value = false) const;
   double AsNumber(double default_value = 0.0) const;
   std::string AsString(const std::string &default_value = "") const;
+  std::string_view AsStringView() const;
   const Array &AsArray() const;
   const Object &AsObject() const;
 
-  const JsonValue *Find(const std::string &key) const;
+  const JsonValue *Find(std::string_view key) const;
 
  private:
-  using Storage = std::variant<std::monostate, bool, double, std::string, Array, Object>;
+  using Storage = std::variant<std::monostate, bool, double, std::pmr::string, Array, Object>;
   Storage storage_{};
 };
 
-class JsonParser {
+// Pull-style reader over a borrowed buffer. Callers walk the document one
+// value at a time and Skip() whatever they do not need, so loaders can fill
+// their own structs without building a JsonValue tree. Typed reads mirror the
+// JsonValue accessors: a value of the wrong type is skipped and the default
+// is returned.
+class JsonReader {
  public:
-  explicit JsonParser(const std::string &input);
-  JsonValue Parse();
+  explicit JsonReader(std::string_view input);
+
+  JsonValue::Type PeekType();
+  bool BeginObject();
+  bool NextMember(std::string_view &key);
+  bool BeginArray();
+  bool NextElement();
+
+  bool ReadBool(bool default_value = false);
+  double ReadNumber(double default_value = 0.0);
+  std::string ReadString(const std::string &default_value = "");
+  std::string_view ReadStringView();
+  void Skip();
+
+  size_t offset() const { return pos_; }
 
  private:
-  const std::string &input_;
+  std::string_view input_;
   size_t pos_ = 0;
+  bool first_entry_ = false;
+  std::string scratch_;
 
   void SkipWhitespace();
   bool Match(char expected);
   char Peek() const;
+  std::string_view ParseString();
+  void SkipString();
+  size_t ScanNumber();
+  double ParseNumber();
+  bool ParseLiteral(std::string_view literal);
+  bool NextEntry(char close);
+  void AppendEscapedUnicode();
+};
+
+class JsonParser {
+ public:
+  explicit JsonParser(std::string_view input,
+                      std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+  JsonValue Parse();
+
+ private:
+  JsonReader reader_;
+  std::pmr::memory_resource *resource_;
+
   JsonValue ParseValue();
   JsonValue ParseObject();
   JsonValue ParseArray();
-  std::string ParseString();
-  double ParseNumber();
-  bool ParseLiteral(const std::string &literal);
+};
+
+// A parsed tree whose nodes and string bytes all live in one arena owned by
+// the document. The root is never destroyed; dropping the document releases
+// the arena in one step instead of walking the tree.
+class JsonDocument {
+ public:
+  static JsonDocument Parse(std::string_view input);
+
+  const JsonValue &root() const { return *root_; }
+
+ private:
+  std::unique_ptr<std::pmr::monotonic_buffer_resource> arena_;
+  const JsonValue *root_ = nullptr;
+};
+
+// Streaming writer that appends compact JSON to a growable buffer. Reuse one
+// writer with Clear() to keep the buffer's capacity between documents. When
+// constructed with a file descriptor, the buffer is written out whenever it
+// grows past kFlushBytes and on Flush(), so large documents never sit in
+// memory whole. Doubles use the shortest form that round-trips.
+class JsonWriter {
+ public:
+  static constexpr size_t kFlushBytes = 64 * 1024;
+
+  JsonWriter();
+  explicit JsonWriter(int fd);
+
+  void BeginObject();
+  void EndObject();
+  void BeginArray();
+  void EndArray();
+  void WriteKey(std::string_view key);
+  void WriteString(std::string_view value);
+  void WriteNumber(double value);
+  void WriteBool(bool value);
+  void WriteNull();
+  void WriteValue(const JsonValue &value);
+
+  bool Flush();
+  void Clear();
+  std::string_view view() const { return buffer_; }
+  bool ok() const { return ok_; }
+
+ private:
+  std::string buffer_;
+  int fd_ = -1;
+  bool needs_comma_ = false;
+  bool ok_ = true;
+
+  void BeginValue();
+  void AppendEscaped(std::string_view value);
+  void MaybeFlush();
 };
 
 std::string JsonStringify(const JsonValue &value);
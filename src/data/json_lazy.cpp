@@ -0,0 +1,204 @@
+#include "data/json_lazy.h"
+
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace vita::data {
+
+struct LazyJsonTape {
+  static constexpr uint32_t kPooledKey = 0x80000000u;
+
+  std::string_view input;
+  std::vector<LazyJsonValue> nodes;
+  std::string key_pool;
+  mutable std::mutex decoded_mutex;
+  mutable std::unordered_map<const LazyJsonValue *, std::string> decoded;
+};
+
+size_t LazyJsonValue::Array::size() const {
+  size_t count = 0;
+  for (auto iter = begin(); iter != end(); ++iter) {
+    ++count;
+  }
+  return count;
+}
+
+size_t LazyJsonValue::Object::size() const {
+  size_t count = 0;
+  for (auto iter = begin(); iter != end(); ++iter) {
+    ++count;
+  }
+  return count;
+}
+
+JsonValue::Type LazyJsonValue::type() const {
+  switch (tape_->input[offset_]) {
+    case '{':
+      return JsonValue::Type::kObject;
+    case '[':
+      return JsonValue::Type::kArray;
+    case '"':
+      return JsonValue::Type::kString;
+    case 't':
+    case 'f':
+      return JsonValue::Type::kBool;
+    case 'n':
+      return JsonValue::Type::kNull;
+    default:
+      return JsonValue::Type::kNumber;
+  }
+}
+
+bool LazyJsonValue::IsNull() const {
+  return type() == JsonValue::Type::kNull;
+}
+
+bool LazyJsonValue::AsBool(bool default_value) const {
+  if (type() != JsonValue::Type::kBool) {
+    return default_value;
+  }
+  return tape_->input[offset_] == 't';
+}
+
+double LazyJsonValue::AsNumber(double default_value) const {
+  if (type() != JsonValue::Type::kNumber) {
+    return default_value;
+  }
+  JsonReader reader(raw());
+  return reader.ReadNumber(default_value);
+}
+
+std::string LazyJsonValue::AsString(const std::string &default_value) const {
+  if (type() != JsonValue::Type::kString) {
+    return default_value;
+  }
+  return std::string(AsStringView());
+}
+
+// Unescaped strings are views into the input. Escaped ones are decoded once
+// and cached on the tape so the returned view stays valid.
+std::string_view LazyJsonValue::AsStringView() const {
+  if (type() != JsonValue::Type::kString) {
+    return {};
+  }
+  const std::string_view text = raw();
+  if (text.find('\\') == std::string_view::npos) {
+    return text.substr(1, text.size() - 2);
+  }
+  std::lock_guard<std::mutex> lock(tape_->decoded_mutex);
+  auto iter = tape_->decoded.find(this);
+  if (iter == tape_->decoded.end()) {
+    JsonReader reader(text);
+    iter = tape_->decoded.emplace(this, reader.ReadString()).first;
+  }
+  return iter->second;
+}
+
+LazyJsonValue::Array LazyJsonValue::AsArray() const {
+  if (type() != JsonValue::Type::kArray) {
+    return Array(this, this);
+  }
+  return Array(this + 1, this + subtree_size_);
+}
+
+LazyJsonValue::Object LazyJsonValue::AsObject() const {
+  if (type() != JsonValue::Type::kObject) {
+    return Object(this, this);
+  }
+  return Object(this + 1, this + subtree_size_);
+}
+
+const LazyJsonValue *LazyJsonValue::Find(std::string_view key) const {
+  if (type() != JsonValue::Type::kObject) {
+    return nullptr;
+  }
+  const LazyJsonValue *last = this + subtree_size_;
+  for (const LazyJsonValue *node = this + 1; node != last; node += node->subtree_size_) {
+    if (node->key() == key) {
+      return node;
+    }
+  }
+  return nullptr;
+}
+
+std::string_view LazyJsonValue::raw() const {
+  return tape_->input.substr(offset_, end_ - offset_);
+}
+
+std::string_view LazyJsonValue::key() const {
+  if (key_length_ & LazyJsonTape::kPooledKey) {
+    return std::string_view(tape_->key_pool)
+        .substr(key_offset_, key_length_ & ~LazyJsonTape::kPooledKey);
+  }
+  return tape_->input.substr(key_offset_, key_length_);
+}
+
+static uint32_t ToOffset(size_t value) {
+  if (value >= LazyJsonTape::kPooledKey) {
+    throw std::runtime_error("JSON document too large for lazy indexing");
+  }
+  return static_cast<uint32_t>(value);
+}
+
+void LazyJsonDocument::Index(LazyJsonTape &tape, JsonReader &reader, std::string_view key) {
+  const JsonValue::Type type = reader.PeekType();
+  const size_t index = tape.nodes.size();
+  tape.nodes.emplace_back();
+  {
+    LazyJsonValue &node = tape.nodes.back();
+    node.tape_ = &tape;
+    node.offset_ = ToOffset(reader.offset());
+    const std::string_view input = tape.input;
+    if (key.data() >= input.data() && key.data() <= input.data() + input.size()) {
+      node.key_offset_ = ToOffset(static_cast<size_t>(key.data() - input.data()));
+      node.key_length_ = ToOffset(key.size());
+    } else if (!key.empty()) {
+      node.key_offset_ = ToOffset(tape.key_pool.size());
+      node.key_length_ = ToOffset(key.size()) | LazyJsonTape::kPooledKey;
+      tape.key_pool.append(key);
+    }
+  }
+  if (type == JsonValue::Type::kObject) {
+    reader.BeginObject();
+    std::string_view member;
+    while (reader.NextMember(member)) {
+      Index(tape, reader, member);
+    }
+  } else if (type == JsonValue::Type::kArray) {
+    reader.BeginArray();
+    while (reader.NextElement()) {
+      Index(tape, reader, {});
+    }
+  } else {
+    reader.Skip();
+  }
+  LazyJsonValue &node = tape.nodes[index];
+  node.end_ = ToOffset(reader.offset());
+  node.subtree_size_ = ToOffset(tape.nodes.size() - index);
+}
+
+LazyJsonDocument::LazyJsonDocument() = default;
+LazyJsonDocument::~LazyJsonDocument() = default;
+LazyJsonDocument::LazyJsonDocument(LazyJsonDocument &&other) noexcept = default;
+LazyJsonDocument &LazyJsonDocument::operator=(LazyJsonDocument &&other) noexcept = default;
+
+LazyJsonDocument LazyJsonDocument::Parse(std::string_view input) {
+  LazyJsonDocument document;
+  document.tape_ = std::make_unique<LazyJsonTape>();
+  document.tape_->input = input;
+  document.tape_->nodes.reserve(input.size() / 64 + 1);
+  JsonReader reader(input);
+  Index(*document.tape_, reader, {});
+  return document;
+}
+
+const LazyJsonValue &LazyJsonDocument::root() const {
+  return tape_->nodes.front();
+}
+
+size_t LazyJsonDocument::tape_size() const {
+  return tape_->nodes.size();
+}
+
+}  // namespace vita::data
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "data/json.h"
+
+namespace vita::data {
+
+struct LazyJsonTape;
+
+// One value on a LazyJsonDocument tape. It offers the same accessors as
+// JsonValue, so code written against Find/AsArray/AsObject works on either,
+// but nothing is decoded until an accessor asks for it. Each node knows the
+// size of its subtree, so stepping over a sibling is a pointer bump.
+class LazyJsonValue {
+ public:
+  class Array {
+   public:
+    class Iterator {
+     public:
+      explicit Iterator(const LazyJsonValue *node) : node_(node) {}
+      const LazyJsonValue &operator*() const { return *node_; }
+      Iterator &operator++() {
+        node_ += node_->subtree_size_;
+        return *this;
+      }
+      bool operator!=(const Iterator &other) const { return node_ != other.node_; }
+
+     private:
+      const LazyJsonValue *node_;
+    };
+
+    Array(const LazyJsonValue *first, const LazyJsonValue *last) : first_(first), last_(last) {}
+    Iterator begin() const { return Iterator(first_); }
+    Iterator end() const { return Iterator(last_); }
+    bool empty() const { return first_ == last_; }
+    size_t size() const;
+
+   private:
+    const LazyJsonValue *first_;
+    const LazyJsonValue *last_;
+  };
+
+  class Object {
+   public:
+    using Member = std::pair<std::string_view, const LazyJsonValue &>;
+
+    class Iterator {
+     public:
+      explicit Iterator(const LazyJsonValue *node) : node_(node) {}
+      Member operator*() const { return Member(node_->key(), *node_); }
+      Iterator &operator++() {
+        node_ += node_->subtree_size_;
+        return *this;
+      }
+      bool operator!=(const Iterator &other) const { return node_ != other.node_; }
+
+     private:
+      const LazyJsonValue *node_;
+    };
+
+    Object(const LazyJsonValue *first, const LazyJsonValue *last) : first_(first), last_(last) {}
+    Iterator begin() const { return Iterator(first_); }
+    Iterator end() const { return Iterator(last_); }
+    bool empty() const { return first_ == last_; }
+    size_t size() const;
+
+   private:
+    const LazyJsonValue *first_;
+    const LazyJsonValue *last_;
+  };
+
+  JsonValue::Type type() const;
+  bool IsNull() const;
+  bool AsBool(bool default_value = false) const;
+  double AsNumber(double default_value = 0.0) const;
+  std::string AsString(const std::string &default_value = "") const;
+  std::string_view AsStringView() const;
+  Array AsArray() const;
+  Object AsObject() const;
+
+  const LazyJsonValue *Find(std::string_view key) const;
+
+  // Source text of the value, e.g. to compare two entries without decoding.
+  std::string_view raw() const;
+  std::string_view key() const;
+
+ private:
+  friend class LazyJsonDocument;
+
+  const LazyJsonTape *tape_ = nullptr;
+  uint32_t offset_ = 0;
+  uint32_t end_ = 0;
+  uint32_t subtree_size_ = 1;
+  uint32_t key_offset_ = 0;
+  uint32_t key_length_ = 0;
+};
+
+// Indexes a borrowed buffer in one pass, recording where every value starts
+// and ends on a flat tape. Strings are decoded on first access and numbers on
+// every access; values that are never touched cost only the index pass. The
+// input must outlive the document.
+class LazyJsonDocument {
+ public:
+  LazyJsonDocument();
+  ~LazyJsonDocument();
+  LazyJsonDocument(LazyJsonDocument &&other) noexcept;
+  LazyJsonDocument &operator=(LazyJsonDocument &&other) noexcept;
+
+  static LazyJsonDocument Parse(std::string_view input);
+
+  const LazyJsonValue &root() const;
+  size_t tape_size() const;
+
+ private:
+  std::unique_ptr<LazyJsonTape> tape_;
+
+  static void Index(LazyJsonTape &tape, JsonReader &reader, std::string_view key);
+};
+
+}  // namespace vita::data
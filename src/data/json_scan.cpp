@@ -0,0 +1,283 @@
+#include "data/json_scan.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define VITA_JSON_SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+namespace vita::data {
+
+namespace {
+
+struct ScanKernels {
+  JsonScanKernel kind;
+  size_t (*whitespace)(const char *, size_t, size_t);
+  size_t (*quote_or_backslash)(const char *, size_t, size_t);
+  size_t (*digits)(const char *, size_t, size_t);
+  size_t (*escape)(const char *, size_t, size_t);
+};
+
+size_t ScalarWhitespace(const char *data, size_t pos, size_t size) {
+  while (pos < size && IsJsonWhitespace(data[pos])) {
+    ++pos;
+  }
+  return pos;
+}
+
+size_t ScalarQuoteOrBackslash(const char *data, size_t pos, size_t size) {
+  while (pos < size && data[pos] != '"' && data[pos] != '\\') {
+    ++pos;
+  }
+  return pos;
+}
+
+size_t ScalarDigits(const char *data, size_t pos, size_t size) {
+  while (pos < size && IsJsonDigit(data[pos])) {
+    ++pos;
+  }
+  return pos;
+}
+
+size_t ScalarEscape(const char *data, size_t pos, size_t size) {
+  while (pos < size) {
+    const unsigned char ch = static_cast<unsigned char>(data[pos]);
+    if (ch < 0x20 || ch == '"' || ch == '\\') {
+      break;
+    }
+    ++pos;
+  }
+  return pos;
+}
+
+#ifdef VITA_JSON_SCAN_X86
+
+// The vector kernels test 16 or 32 bytes at a time and build a bitmask of
+// bytes that end the run; the lowest set bit is the answer. The tail shorter
+// than one vector is handed to the scalar loop.
+
+__attribute__((target("sse2"))) inline __m128i Sse2WhitespaceMask(__m128i chunk) {
+  __m128i mask = _mm_cmpeq_epi8(chunk, _mm_set1_epi8(' '));
+  mask = _mm_or_si128(mask, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n')));
+  mask = _mm_or_si128(mask, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r')));
+  return _mm_or_si128(mask, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\t')));
+}
+
+__attribute__((target("sse2"))) size_t Sse2Whitespace(const char *data, size_t pos,
+                                                       size_t size) {
+  while (pos + 16 <= size) {
+    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos));
+    const unsigned stop = ~static_cast<unsigned>(_mm_movemask_epi8(Sse2WhitespaceMask(chunk))) &
+                          0xFFFFu;
+    if (stop != 0) {
+      return pos + static_cast<size_t>(__builtin_ctz(stop));
+    }
+    pos += 16;
+  }
+  return ScalarWhitespace(data, pos, size);
+}
+
+__attribute__((target("sse2"))) size_t Sse2QuoteOrBackslash(const char *data, size_t pos,
+                                                             size_t size) {
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  while (pos + 16 <= size) {
+    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos));
+    const __m128i hits =
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash));
+    const unsigned stop = static_cast<unsigned>(_mm_movemask_epi8(hits));
+    if (stop != 0) {
+      return pos + static_cast<size_t>(__builtin_ctz(stop));
+    }
+    pos += 16;
+  }
+  return ScalarQuoteOrBackslash(data, pos, size);
+}
+
+__attribute__((target("sse2"))) size_t Sse2Digits(const char *data, size_t pos, size_t size) {
+  const __m128i below = _mm_set1_epi8('0' - 1);
+  const __m128i above = _mm_set1_epi8('9' + 1);
+  while (pos + 16 <= size) {
+    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos));
+    const __m128i digits =
+        _mm_and_si128(_mm_cmpgt_epi8(chunk, below), _mm_cmplt_epi8(chunk, above));
+    const unsigned stop = ~static_cast<unsigned>(_mm_movemask_epi8(digits)) & 0xFFFFu;
+    if (stop != 0) {
+      return pos + static_cast<size_t>(__builtin_ctz(stop));
+    }
+    pos += 16;
+  }
+  return ScalarDigits(data, pos, size);
+}
+
+__attribute__((target("sse2"))) size_t Sse2Escape(const char *data, size_t pos, size_t size) {
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  const __m128i control_max = _mm_set1_epi8(0x1F);
+  while (pos + 16 <= size) {
+    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos));
+    __m128i hits = _mm_cmpeq_epi8(_mm_min_epu8(chunk, control_max), chunk);
+    hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, quote));
+    hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, backslash));
+    const unsigned stop = static_cast<unsigned>(_mm_movemask_epi8(hits));
+    if (stop != 0) {
+      return pos + static_cast<size_t>(__builtin_ctz(stop));
+    }
+    pos += 16;
+  }
+  return ScalarEscape(data, pos, size);
+}
+
+__attribute__((target("avx2"))) size_t Avx2Whitespace(const char *data, size_t pos,
+                                                       size_t size) {
+  while (pos + 32 <= size) {
+    const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + pos));
+    __m256i mask = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(' '));
+    mask = _mm256_or_si256(mask, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\n')));
+    mask = _mm256_or_si256(mask, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\r')));
+    mask = _mm256_or_si256(mask, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\t')));
+    const unsigned stop = ~static_cast<unsigned>(_mm256_movemask_epi8(mask));
+    if (stop != 0) {
+      return pos + static_cast<size_t>(__builtin_ctz(stop));
+    }
+    pos += 32;
+  }
+  return Sse2Whitespace(data, pos, size);
+}
+
+__attribute__((target("avx2"))) size_t Avx2QuoteOrBackslash(const char *data, size_t pos,
+                                                             size_t size) {
+  const __m256i quote = _mm256_set1_epi8('"');
+  const __m256i backslash = _mm256_set1_epi8('\\');
+  while (pos + 32 <= size) {
+    const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + pos));
+    const __m256i hits =
+        _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, backslash));
+    const unsigned stop = static_cast<unsigned>(_mm256_movemask_epi8(hits));
+    if (stop != 0) {
+      return pos + static_cast<size_t>(__builtin_ctz(stop));
+    }
+    pos += 32;
+  }
+  return Sse2QuoteOrBackslash(data, pos, size);
+}
+
+__attribute__((target("avx2"))) size_t Avx2Digits(const char *data, size_t pos, size_t size) {
+  const __m256i below = _mm256_set1_epi8('0' - 1);
+  const __m256i above = _mm256_set1_epi8('9' + 1);
+  while (pos + 32 <= size) {
+    const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + pos));
+    const __m256i digits =
+        _mm256_and_si256(_mm256_cmpgt_epi8(chunk, below), _mm256_cmpgt_epi8(above, chunk));
+    const unsigned stop = ~static_cast<unsigned>(_mm256_movemask_epi8(digits));
+    if (stop != 0) {
+      return pos + static_cast<size_t>(__builtin_ctz(stop));
+    }
+    pos += 32;
+  }
+  return Sse2Digits(data, pos, size);
+}
+
+__attribute__((target("avx2"))) size_t Avx2Escape(const char *data, size_t pos, size_t size) {
+  const __m256i quote = _mm256_set1_epi8('"');
+  const __m256i backslash = _mm256_set1_epi8('\\');
+  const __m256i control_max = _mm256_set1_epi8(0x1F);
+  while (pos + 32 <= size) {
+    const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + pos));
+    __m256i hits = _mm256_cmpeq_epi8(_mm256_min_epu8(chunk, control_max), chunk);
+    hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(chunk, quote));
+    hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(chunk, backslash));
+    const unsigned stop = static_cast<unsigned>(_mm256_movemask_epi8(hits));
+    if (stop != 0) {
+      return pos + static_cast<size_t>(__builtin_ctz(stop));
+    }
+    pos += 32;
+  }
+  return Sse2Escape(data, pos, size);
+}
+
+#endif  // VITA_JSON_SCAN_X86
+
+constexpr ScanKernels kScalarKernels{JsonScanKernel::kScalar, ScalarWhitespace,
+                                     ScalarQuoteOrBackslash, ScalarDigits, ScalarEscape};
+#ifdef VITA_JSON_SCAN_X86
+constexpr ScanKernels kSse2Kernels{JsonScanKernel::kSse2, Sse2Whitespace, Sse2QuoteOrBackslash,
+                                   Sse2Digits, Sse2Escape};
+constexpr ScanKernels kAvx2Kernels{JsonScanKernel::kAvx2, Avx2Whitespace, Avx2QuoteOrBackslash,
+                                   Avx2Digits, Avx2Escape};
+#endif
+
+const ScanKernels *FindKernels(JsonScanKernel kernel) {
+#ifdef VITA_JSON_SCAN_X86
+  __builtin_cpu_init();
+  if (kernel == JsonScanKernel::kAvx2 && __builtin_cpu_supports("avx2")) {
+    return &kAvx2Kernels;
+  }
+  if (kernel == JsonScanKernel::kSse2 && __builtin_cpu_supports("sse2")) {
+    return &kSse2Kernels;
+  }
+#endif
+  if (kernel == JsonScanKernel::kScalar) {
+    return &kScalarKernels;
+  }
+  return nullptr;
+}
+
+const ScanKernels *SelectBestKernels() {
+  if (const ScanKernels *kernels = FindKernels(JsonScanKernel::kAvx2)) {
+    return kernels;
+  }
+  if (const ScanKernels *kernels = FindKernels(JsonScanKernel::kSse2)) {
+    return kernels;
+  }
+  return &kScalarKernels;
+}
+
+const ScanKernels *&ActiveKernels() {
+  static const ScanKernels *active = SelectBestKernels();
+  return active;
+}
+
+}  // namespace
+
+JsonScanKernel ActiveJsonScanKernel() {
+  return ActiveKernels()->kind;
+}
+
+bool SetJsonScanKernel(JsonScanKernel kernel) {
+  const ScanKernels *kernels = FindKernels(kernel);
+  if (!kernels) {
+    return false;
+  }
+  ActiveKernels() = kernels;
+  return true;
+}
+
+const char *JsonScanKernelName(JsonScanKernel kernel) {
+  switch (kernel) {
+    case JsonScanKernel::kScalar:
+      return "scalar";
+    case JsonScanKernel::kSse2:
+      return "sse2";
+    case JsonScanKernel::kAvx2:
+      return "avx2";
+  }
+  return "unknown";
+}
+
+size_t ScanWhitespace(const char *data, size_t pos, size_t size) {
+  return ActiveKernels()->whitespace(data, pos, size);
+}
+
+size_t ScanToQuoteOrBackslash(const char *data, size_t pos, size_t size) {
+  return ActiveKernels()->quote_or_backslash(data, pos, size);
+}
+
+size_t ScanDigits(const char *data, size_t pos, size_t size) {
+  return ActiveKernels()->digits(data, pos, size);
+}
+
+size_t ScanToEscape(const char *data, size_t pos, size_t size) {
+  return ActiveKernels()->escape(data, pos, size);
+}
+
+}  // namespace vita::data
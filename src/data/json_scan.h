@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+
+namespace vita::data {
+
+// Byte-scanning kernels used by JsonReader. Each returns the first position at
+// or after `pos` that stops the run, or `size` when the input ends first.
+// The best kernel the CPU supports is picked on first use; SetJsonScanKernel
+// overrides it (e.g. to compare kernels) and should be called before parsing.
+enum class JsonScanKernel {
+  kScalar,
+  kSse2,
+  kAvx2,
+};
+
+JsonScanKernel ActiveJsonScanKernel();
+bool SetJsonScanKernel(JsonScanKernel kernel);
+const char *JsonScanKernelName(JsonScanKernel kernel);
+
+inline bool IsJsonWhitespace(char ch) {
+  return ch == ' ' || ch == '\n' || ch == '\r' || ch == '\t';
+}
+
+inline bool IsJsonDigit(char ch) {
+  return ch >= '0' && ch <= '9';
+}
+
+size_t ScanWhitespace(const char *data, size_t pos, size_t size);
+size_t ScanToQuoteOrBackslash(const char *data, size_t pos, size_t size);
+size_t ScanDigits(const char *data, size_t pos, size_t size);
+// Stops at bytes a JSON string must escape: quote, backslash, or < 0x20.
+size_t ScanToEscape(const char *data, size_t pos, size_t size);
+
+}  // namespace vita::data
@@ -1,61 +1,293 @@
 #include "data/library.h"
 
-#include <fstream>
-#include <sstream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
 
 #include "data/json.h"
+#include "data/library_snapshot.h"
+#include "data/mapped_file.h"
 
 namespace vita::data {
 
-static std::vector<std::string> ReadStringArray(const JsonValue &value) {
+static std::vector<std::string> ReadStringArray(JsonReader &reader) {
   std::vector<std::string> result;
-  for (const auto &entry : value.AsArray()) {
-    result.push_back(entry.AsString(""));
+  if (reader.BeginArray()) {
+    while (reader.NextElement()) {
+      result.push_back(reader.ReadString(""));
+    }
   }
   return result;
 }
 
-Library Library::Load(const std::filesystem::path &path) {
-  Library library;
-  std::ifstream file(path);
+static LibraryItem ReadItem(JsonReader &reader) {
+  LibraryItem item;
+  if (!reader.BeginObject()) {
+    return item;
+  }
+  std::string_view key;
+  while (reader.NextMember(key)) {
+    if (key == "id") {
+      item.item_id = ItemId::Intern(reader.ReadStringView());
+    } else if (key == "title") {
+      item.title = reader.ReadString("");
+    } else if (key == "desc") {
+      item.description = reader.ReadString("");
+    } else if (key == "icon") {
+      item.icon_path = reader.ReadString("");
+    } else if (key == "hero") {
+      item.hero_path = reader.ReadString("");
+    } else if (key == "folder") {
+      item.folder = reader.ReadString("");
+    } else if (key == "cmd_linux") {
+      item.cmd_linux = ReadStringArray(reader);
+    } else if (key == "cmd_windows") {
+      item.cmd_windows = ReadStringArray(reader);
+    } else {
+      reader.Skip();
+    }
+  }
+  return item;
+}
+
+static std::vector<LibraryItem> ParseItems(std::string_view text) {
+  std::vector<LibraryItem> items;
+  JsonReader reader(text);
+  if (!reader.BeginArray()) {
+    return items;
+  }
+  while (reader.NextElement()) {
+    LibraryItem item = ReadItem(reader);
+    if (item.item_id.valid()) {
+      items.push_back(std::move(item));
+    }
+  }
+  return items;
+}
+
+static std::vector<LibraryItem> LoadItems(const std::filesystem::path &path) {
+  const MappedFile file = MappedFile::Open(path);
   if (!file.is_open()) {
+    return {};
+  }
+  const LibrarySource source = DescribeLibrarySource(path, file.view());
+  const std::filesystem::path snapshot_path = LibrarySnapshotPath(path);
+  std::vector<LibraryItem> items;
+  if (ReadLibrarySnapshot(snapshot_path, source, items)) {
+    return items;
+  }
+  items = ParseItems(file.view());
+  WriteLibrarySnapshot(snapshot_path, source, items);
+  return items;
+}
+
+Library Library::Load(const std::filesystem::path &path) {
+  std::error_code error;
+  if (std::filesystem::is_directory(path, error)) {
+    Library library = LoadShards(path);
+    library.BuildIndexes();
     return library;
   }
-  std::ostringstream buffer;
-  buffer << file.rdbuf();
-  JsonParser parser(buffer.str());
-  JsonValue root = parser.Parse();
-  for (const auto &entry : root.AsArray()) {
-    LibraryItem item;
-    if (const auto *value = entry.Find("id")) {
-      item.item_id = value->AsString("");
+  Library library;
+  library.items_ = LoadItems(path);
+  library.BuildIndexes();
+  return library;
+}
+
+// The *.json shards of a library directory, in merge (file name) order.
+static std::vector<std::filesystem::path> ShardPaths(const std::filesystem::path &directory) {
+  std::vector<std::filesystem::path> paths;
+  std::error_code error;
+  for (const auto &entry : std::filesystem::directory_iterator(directory, error)) {
+    if (entry.is_regular_file(error) && entry.path().extension() == ".json") {
+      paths.push_back(entry.path());
     }
-    if (const auto *value = entry.Find("title")) {
-      item.title = value->AsString("");
+  }
+  std::sort(paths.begin(), paths.end());
+  return paths;
+}
+
+Library Library::LoadShards(const std::filesystem::path &directory) {
+  Library library;
+  const std::vector<std::filesystem::path> paths = ShardPaths(directory);
+
+  std::vector<std::vector<LibraryItem>> shards(paths.size());
+  std::vector<std::string> errors(paths.size());
+  library.shard_stats_.resize(paths.size());
+  std::atomic<size_t> next_shard{0};
+  auto worker = [&]() {
+    for (size_t index = next_shard++; index < paths.size(); index = next_shard++) {
+      const auto start = std::chrono::steady_clock::now();
+      try {
+        shards[index] = LoadItems(paths[index]);
+      } catch (const std::exception &exception) {
+        errors[index] = exception.what();
+      }
+      auto &stats = library.shard_stats_[index];
+      stats.path = paths[index];
+      stats.item_count = shards[index].size();
+      stats.load_ms = std::chrono::duration<double, std::milli>(
+                          std::chrono::steady_clock::now() - start)
+                          .count();
     }
-    if (const auto *value = entry.Find("desc")) {
-      item.description = value->AsString("");
+  };
+  const size_t thread_count =
+      std::min<size_t>(paths.size(), std::max(1u, std::thread::hardware_concurrency()));
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < thread_count; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (size_t index = 0; index < paths.size(); ++index) {
+    if (!errors[index].empty()) {
+      throw std::runtime_error(paths[index].string() + ": " + errors[index]);
     }
-    if (const auto *value = entry.Find("icon")) {
-      item.icon_path = value->AsString("");
+  }
+
+  std::unordered_map<ItemId, size_t> index_by_id;
+  for (auto &shard : shards) {
+    for (auto &item : shard) {
+      auto [iter, inserted] = index_by_id.emplace(item.item_id, library.items_.size());
+      if (inserted) {
+        library.items_.push_back(std::move(item));
+      } else {
+        library.items_[iter->second] = std::move(item);
+      }
     }
-    if (const auto *value = entry.Find("hero")) {
-      item.hero_path = value->AsString("");
+  }
+  return library;
+}
+
+static char FoldAscii(char ch) {
+  return (ch >= 'A' && ch <= 'Z') ? static_cast<char>(ch - 'A' + 'a') : ch;
+}
+
+static bool TitleLess(std::string_view lhs, std::string_view rhs) {
+  const size_t length = std::min(lhs.size(), rhs.size());
+  for (size_t i = 0; i < length; ++i) {
+    const unsigned char left = static_cast<unsigned char>(FoldAscii(lhs[i]));
+    const unsigned char right = static_cast<unsigned char>(FoldAscii(rhs[i]));
+    if (left != right) {
+      return left < right;
     }
-    if (const auto *value = entry.Find("folder")) {
-      item.folder = value->AsString("");
+  }
+  return lhs.size() < rhs.size();
+}
+
+static bool TitleHasPrefix(std::string_view title, std::string_view prefix) {
+  if (title.size() < prefix.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < prefix.size(); ++i) {
+    if (FoldAscii(title[i]) != FoldAscii(prefix[i])) {
+      return false;
     }
-    if (const auto *value = entry.Find("cmd_linux")) {
-      item.cmd_linux = ReadStringArray(*value);
+  }
+  return true;
+}
+
+void Library::BuildIndexes() {
+  id_index_.clear();
+  id_index_.reserve(items_.size());
+  title_index_.resize(items_.size());
+  for (uint32_t index = 0; index < items_.size(); ++index) {
+    id_index_[items_[index].item_id] = index;
+    title_index_[index] = index;
+  }
+  std::stable_sort(title_index_.begin(), title_index_.end(), [this](uint32_t lhs, uint32_t rhs) {
+    return TitleLess(items_[lhs].title, items_[rhs].title);
+  });
+}
+
+const LibraryItem *Library::Find(ItemId id) const {
+  auto iter = id_index_.find(id);
+  if (iter == id_index_.end()) {
+    return nullptr;
+  }
+  return &items_[iter->second];
+}
+
+LibraryTitleRange Library::TitleRange(const uint32_t *first, const uint32_t *last) const {
+  return LibraryTitleRange(&items_, first, last);
+}
+
+LibraryTitleRange Library::ByTitle() const {
+  return TitleRange(title_index_.data(), title_index_.data() + title_index_.size());
+}
+
+LibraryTitleRange Library::TitlesWithPrefix(std::string_view prefix) const {
+  auto first = std::lower_bound(title_index_.begin(), title_index_.end(), prefix,
+                                [this](uint32_t index, std::string_view value) {
+                                  return TitleLess(items_[index].title, value);
+                                });
+  auto last = std::partition_point(first, title_index_.end(), [this, prefix](uint32_t index) {
+    return TitleHasPrefix(items_[index].title, prefix);
+  });
+  return TitleRange(title_index_.data() + (first - title_index_.begin()),
+                    title_index_.data() + (last - title_index_.begin()));
+}
+
+LibraryTitleRange Library::TitlesBetween(std::string_view first, std::string_view last) const {
+  auto compare = [this](uint32_t index, std::string_view value) {
+    return TitleLess(items_[index].title, value);
+  };
+  auto lower = std::lower_bound(title_index_.begin(), title_index_.end(), first, compare);
+  auto upper = std::lower_bound(lower, title_index_.end(), last, compare);
+  if (TitleLess(last, first)) {
+    upper = lower;
+  }
+  return TitleRange(title_index_.data() + (lower - title_index_.begin()),
+                    title_index_.data() + (upper - title_index_.begin()));
+}
+
+static bool SameItem(const LibraryItem &lhs, const LibraryItem &rhs) {
+  return lhs.title == rhs.title && lhs.description == rhs.description &&
+         lhs.icon_path == rhs.icon_path && lhs.hero_path == rhs.hero_path &&
+         lhs.folder == rhs.folder && lhs.cmd_linux == rhs.cmd_linux &&
+         lhs.cmd_windows == rhs.cmd_windows;
+}
+
+LibraryDiff Library::Diff(const Library &before, const Library &after) {
+  LibraryDiff diff;
+  for (const LibraryItem &item : after.items_) {
+    const LibraryItem *previous = before.Find(item.item_id);
+    if (!previous) {
+      diff.added.push_back(item.item_id);
+    } else if (!SameItem(*previous, item)) {
+      diff.changed.push_back(item.item_id);
     }
-    if (const auto *value = entry.Find("cmd_windows")) {
-      item.cmd_windows = ReadStringArray(*value);
+  }
+  for (const LibraryItem &item : before.items_) {
+    if (!after.Find(item.item_id)) {
+      diff.removed.push_back(item.item_id);
     }
-    if (!item.item_id.empty()) {
-      library.items_.push_back(std::move(item));
+  }
+  return diff;
+}
+
+bool Library::CompileSnapshot(const std::filesystem::path &path) {
+  std::error_code error;
+  if (std::filesystem::is_directory(path, error)) {
+    const std::vector<std::filesystem::path> paths = ShardPaths(path);
+    bool compiled = !paths.empty();
+    for (const auto &shard : paths) {
+      compiled = CompileSnapshot(shard) && compiled;
     }
+    return compiled;
   }
-  return library;
+  const MappedFile file = MappedFile::Open(path);
+  if (!file.is_open()) {
+    return false;
+  }
+  const LibrarySource source = DescribeLibrarySource(path, file.view());
+  return WriteLibrarySnapshot(LibrarySnapshotPath(path), source, ParseItems(file.view()));
 }
 
 }  // namespace vita::data
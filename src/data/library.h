@@ -1,13 +1,18 @@
 #pragma once
 
+#include <cstdint>
 #include <filesystem>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
+#include "data/item_id.h"
+
 namespace vita::data {
 
 struct LibraryItem {
-  std::string item_id;
+  ItemId item_id;
   std::string title;
   std::string description;
   std::string icon_path;
@@ -17,14 +22,91 @@ struct LibraryItem {
   std::vector<std::string> cmd_windows;
 };
 
+struct LibraryShardStats {
+  std::filesystem::path path;
+  size_t item_count = 0;
+  double load_ms = 0.0;
+};
+
+// Per-item changes between two loads of the library, keyed by id.
+struct LibraryDiff {
+  std::vector<ItemId> added;
+  std::vector<ItemId> removed;
+  std::vector<ItemId> changed;
+
+  size_t size() const { return added.size() + removed.size() + changed.size(); }
+  bool empty() const { return size() == 0; }
+};
+
+// Items in title order, as returned by the title index queries.
+class LibraryTitleRange {
+ public:
+  class Iterator {
+   public:
+    Iterator(const std::vector<LibraryItem> *items, const uint32_t *index)
+        : items_(items), index_(index) {}
+    const LibraryItem &operator*() const { return (*items_)[*index_]; }
+    const LibraryItem *operator->() const { return &(*items_)[*index_]; }
+    Iterator &operator++() {
+      ++index_;
+      return *this;
+    }
+    bool operator!=(const Iterator &other) const { return index_ != other.index_; }
+
+   private:
+    const std::vector<LibraryItem> *items_;
+    const uint32_t *index_;
+  };
+
+  LibraryTitleRange(const std::vector<LibraryItem> *items, const uint32_t *first,
+                    const uint32_t *last)
+      : items_(items), first_(first), last_(last) {}
+  Iterator begin() const { return Iterator(items_, first_); }
+  Iterator end() const { return Iterator(items_, last_); }
+  size_t size() const { return static_cast<size_t>(last_ - first_); }
+  bool empty() const { return first_ == last_; }
+  const LibraryItem &operator[](size_t index) const { return (*items_)[first_[index]]; }
+
+ private:
+  const std::vector<LibraryItem> *items_;
+  const uint32_t *first_;
+  const uint32_t *last_;
+};
+
 class Library {
  public:
+  // Loads from the binary snapshot next to `path` when it matches the JSON,
+  // otherwise parses the JSON and refreshes the snapshot. When `path` is a
+  // directory, every *.json shard in it is loaded on a worker pool and merged
+  // in file name order; a later shard replaces an earlier item with the same
+  // id in place.
   static Library Load(const std::filesystem::path &path);
+  // Writes the binary snapshot for `path`, or for each *.json shard when it
+  // is a directory. False if any snapshot could not be written or the
+  // directory has no shards.
+  static bool CompileSnapshot(const std::filesystem::path &path);
+  static LibraryDiff Diff(const Library &before, const Library &after);
 
   const std::vector<LibraryItem> &items() const { return items_; }
+  const std::vector<LibraryShardStats> &shard_stats() const { return shard_stats_; }
+
+  // Both indexes are built once at load time. Title queries compare ASCII
+  // case-insensitively; range bounds are [first, last).
+  const LibraryItem *Find(ItemId id) const;
+  LibraryTitleRange ByTitle() const;
+  LibraryTitleRange TitlesWithPrefix(std::string_view prefix) const;
+  LibraryTitleRange TitlesBetween(std::string_view first, std::string_view last) const;
 
  private:
   std::vector<LibraryItem> items_;
+  std::vector<LibraryShardStats> shard_stats_;
+  std::unordered_map<ItemId, uint32_t> id_index_;
+  std::vector<uint32_t> title_index_;
+
+  void BuildIndexes();
+  LibraryTitleRange TitleRange(const uint32_t *first, const uint32_t *last) const;
+
+  static Library LoadShards(const std::filesystem::path &directory);
 };
 
 }  // namespace vita::data
@@ -0,0 +1,121 @@
+#include "data/library_reloader.h"
+
+#include <chrono>
+#include <exception>
+#include <utility>
+
+#include "ui/constants.h"
+
+namespace vita::data {
+
+LibraryReloader::LibraryReloader(std::filesystem::path path, const Library &library,
+                                 std::function<void()> on_ready)
+    : path_(std::move(path)), live_(library), on_ready_(std::move(on_ready)), watcher_(path_) {
+  if (watcher_.is_open()) {
+    worker_ = std::thread(&LibraryReloader::Run, this);
+  }
+}
+
+LibraryReloader::~LibraryReloader() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  consumed_.notify_all();
+  watcher_.Wake();
+  if (worker_.joinable()) {
+    worker_.join();
+  }
+}
+
+std::optional<LibraryReloader::Report> LibraryReloader::Apply(Library &library,
+                                                              RuntimeState &state) {
+  std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+  if (!lock.owns_lock() || !result_) {
+    return std::nullopt;
+  }
+  Result result = std::move(*result_);
+  result_.reset();
+  if (result.report.error.empty()) {
+    const auto start = std::chrono::steady_clock::now();
+    std::swap(library, result.library);
+    ApplyLibraryDiff(result.diff, state);
+    result.report.apply_ms = std::chrono::duration<double, std::milli>(
+                                 std::chrono::steady_clock::now() - start)
+                                 .count();
+    retired_ = std::move(result.library);
+  }
+  lock.unlock();
+  consumed_.notify_all();
+  return result.report;
+}
+
+void LibraryReloader::Run() {
+  while (true) {
+    std::optional<Library> retired;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      // The live library may only be read while no result is pending, since
+      // Apply() replaces it.
+      consumed_.wait(lock, [this] { return stopping_ || !result_; });
+      if (stopping_) {
+        return;
+      }
+      retired.swap(retired_);
+    }
+    retired.reset();
+    if (!watcher_.Wait(-1)) {
+      continue;
+    }
+    while (watcher_.Wait(kSettleMs)) {
+    }
+
+    Result result;
+    const auto start = std::chrono::steady_clock::now();
+    try {
+      result.library = Library::Load(path_);
+      result.diff = Library::Diff(live_, result.library);
+      result.report.added = result.diff.added.size();
+      result.report.removed = result.diff.removed.size();
+      result.report.changed = result.diff.changed.size();
+    } catch (const std::exception &error) {
+      result.report.error = error.what();
+    }
+    result.report.load_ms =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+            .count();
+    if (result.report.error.empty() && result.diff.empty()) {
+      continue;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      result_ = std::move(result);
+    }
+    if (on_ready_) {
+      on_ready_();
+    }
+  }
+}
+
+void ApplyLibraryDiff(const LibraryDiff &diff, RuntimeState &state) {
+  for (ItemId id : diff.removed) {
+    state.RemoveEntry(id);
+  }
+  constexpr size_t kIconsPerPage = static_cast<size_t>(ui::kGridColumns * ui::kGridRows);
+  for (ItemId id : diff.added) {
+    if (state.Find(id) || state.icon_count() >= static_cast<size_t>(ui::kMaxIcons)) {
+      continue;
+    }
+    size_t page = state.pages.empty() ? 0 : state.pages.size() - 1;
+    if (page < state.pages.size() && state.pages[page].size() >= kIconsPerPage) {
+      ++page;
+    }
+    if (page >= static_cast<size_t>(ui::kMaxPages)) {
+      break;
+    }
+    const size_t slot = page < state.pages.size() ? state.pages[page].size() : 0;
+    state.MoveEntry(id, page, slot);
+  }
+}
+
+}  // namespace vita::data
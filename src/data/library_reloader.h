@@ -0,0 +1,78 @@
+#pragma once
+
+#include <condition_variable>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include "data/file_watcher.h"
+#include "data/library.h"
+#include "data/state.h"
+
+namespace vita::data {
+
+// Reloads the library when its file (or shard directory) changes. A worker
+// thread waits on the watcher, lets bursts of writes settle for kSettleMs,
+// then loads and diffs the new library against the live one. The render
+// thread calls Apply() between frames; when a reload is ready it swaps the
+// new library in (the old one is handed back to the worker to free) and
+// updates the layout for added and removed items in one step. Lookups are
+// by ItemId, so anything keyed on an unchanged item survives the swap.
+class LibraryReloader {
+ public:
+  static constexpr int kSettleMs = 150;
+
+  struct Report {
+    size_t added = 0;
+    size_t removed = 0;
+    size_t changed = 0;
+    double load_ms = 0.0;
+    double apply_ms = 0.0;
+    std::string error;
+  };
+
+  // `on_ready` runs on the worker thread whenever a result is waiting for
+  // Apply(), so a sleeping main loop can be woken.
+  LibraryReloader(std::filesystem::path path, const Library &library,
+                  std::function<void()> on_ready = {});
+  ~LibraryReloader();
+
+  LibraryReloader(const LibraryReloader &) = delete;
+  LibraryReloader &operator=(const LibraryReloader &) = delete;
+
+  bool watching() const { return watcher_.is_open(); }
+
+  // `library` must be the instance passed to the constructor.
+  std::optional<Report> Apply(Library &library, RuntimeState &state);
+
+ private:
+  struct Result {
+    Library library;
+    LibraryDiff diff;
+    Report report;
+  };
+
+  void Run();
+
+  std::filesystem::path path_;
+  const Library &live_;
+  std::function<void()> on_ready_;
+  FileWatcher watcher_;
+
+  std::mutex mutex_;
+  std::condition_variable consumed_;
+  std::optional<Result> result_;
+  std::optional<Library> retired_;
+  bool stopping_ = false;
+
+  std::thread worker_;
+};
+
+// Drops removed items from the layout and places added ones in the first
+// free slots after the last icon, within the page and icon limits.
+void ApplyLibraryDiff(const LibraryDiff &diff, RuntimeState &state);
+
+}  // namespace vita::data
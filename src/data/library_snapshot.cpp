@@ -0,0 +1,210 @@
+#include "data/library_snapshot.h"
+
+#include <cstring>
+#include <system_error>
+#include <tuple>
+#include <utility>
+
+#include "data/file_util.h"
+#include "data/mapped_file.h"
+
+namespace vita::data {
+
+namespace {
+
+constexpr char kMagic[8] = {'V', 'I', 'T', 'A', 'L', 'I', 'B', '\0'};
+constexpr uint32_t kVersion = 1;
+
+struct SnapshotHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t item_count;
+  uint64_t source_size;
+  int64_t source_mtime;
+  uint64_t source_hash;
+  uint32_t arg_count;
+  uint32_t pool_size;
+};
+
+struct StringRef {
+  uint32_t offset;
+  uint32_t length;
+};
+
+struct ItemRecord {
+  StringRef item_id;
+  StringRef title;
+  StringRef description;
+  StringRef icon_path;
+  StringRef hero_path;
+  StringRef folder;
+  uint32_t linux_first;
+  uint32_t linux_count;
+  uint32_t windows_first;
+  uint32_t windows_count;
+};
+
+static_assert(sizeof(SnapshotHeader) == 48, "snapshot header layout changed");
+static_assert(sizeof(ItemRecord) == 64, "snapshot record layout changed");
+
+class SnapshotBuilder {
+ public:
+  StringRef Add(const std::string &value) {
+    StringRef ref{static_cast<uint32_t>(pool_.size()), static_cast<uint32_t>(value.size())};
+    pool_.append(value);
+    return ref;
+  }
+
+  std::pair<uint32_t, uint32_t> AddArgs(const std::vector<std::string> &values) {
+    const uint32_t first = static_cast<uint32_t>(args_.size());
+    for (const auto &value : values) {
+      args_.push_back(Add(value));
+    }
+    return {first, static_cast<uint32_t>(values.size())};
+  }
+
+  const std::string &pool() const { return pool_; }
+  const std::vector<StringRef> &args() const { return args_; }
+
+ private:
+  std::string pool_;
+  std::vector<StringRef> args_;
+};
+
+}  // namespace
+
+LibrarySource DescribeLibrarySource(const std::filesystem::path &path, std::string_view contents) {
+  LibrarySource source;
+  source.size = contents.size();
+  std::error_code error;
+  const auto mtime = std::filesystem::last_write_time(path, error);
+  if (!error) {
+    source.mtime = static_cast<int64_t>(mtime.time_since_epoch().count());
+  }
+  source.hash = HashBytes(contents);
+  return source;
+}
+
+std::filesystem::path LibrarySnapshotPath(const std::filesystem::path &json_path) {
+  std::filesystem::path snapshot = json_path;
+  snapshot += ".snap";
+  return snapshot;
+}
+
+bool ReadLibrarySnapshot(const std::filesystem::path &snapshot_path, const LibrarySource &source,
+                         std::vector<LibraryItem> &items) {
+  const MappedFile file = MappedFile::Open(snapshot_path);
+  const std::string_view data = file.view();
+  SnapshotHeader header{};
+  if (!file.is_open() || data.size() < sizeof(header)) {
+    return false;
+  }
+  std::memcpy(&header, data.data(), sizeof(header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion ||
+      header.source_size != source.size || header.source_mtime != source.mtime ||
+      header.source_hash != source.hash) {
+    return false;
+  }
+  const size_t records_offset = sizeof(header);
+  const size_t args_offset = records_offset + size_t{header.item_count} * sizeof(ItemRecord);
+  const size_t pool_offset = args_offset + size_t{header.arg_count} * sizeof(StringRef);
+  if (pool_offset + header.pool_size != data.size()) {
+    return false;
+  }
+  const std::string_view pool = data.substr(pool_offset, header.pool_size);
+  auto valid = [&](const StringRef &ref) {
+    return ref.offset <= pool.size() && ref.length <= pool.size() - ref.offset;
+  };
+  auto text = [&](const StringRef &ref) {
+    return std::string(pool.substr(ref.offset, ref.length));
+  };
+  auto args = [&](uint32_t first, uint32_t count, std::vector<std::string> &out) {
+    if (first > header.arg_count || count > header.arg_count - first) {
+      return false;
+    }
+    out.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+      StringRef ref{};
+      std::memcpy(&ref, data.data() + args_offset + size_t{first + i} * sizeof(StringRef),
+                  sizeof(ref));
+      if (!valid(ref)) {
+        return false;
+      }
+      out.push_back(text(ref));
+    }
+    return true;
+  };
+
+  std::vector<LibraryItem> result;
+  result.reserve(header.item_count);
+  for (uint32_t index = 0; index < header.item_count; ++index) {
+    ItemRecord record{};
+    std::memcpy(&record, data.data() + records_offset + size_t{index} * sizeof(ItemRecord),
+                sizeof(record));
+    for (const StringRef &ref : {record.item_id, record.title, record.description,
+                                 record.icon_path, record.hero_path, record.folder}) {
+      if (!valid(ref)) {
+        return false;
+      }
+    }
+    LibraryItem item;
+    item.item_id = ItemId::Intern(pool.substr(record.item_id.offset, record.item_id.length));
+    item.title = text(record.title);
+    item.description = text(record.description);
+    item.icon_path = text(record.icon_path);
+    item.hero_path = text(record.hero_path);
+    item.folder = text(record.folder);
+    if (!args(record.linux_first, record.linux_count, item.cmd_linux) ||
+        !args(record.windows_first, record.windows_count, item.cmd_windows)) {
+      return false;
+    }
+    result.push_back(std::move(item));
+  }
+  items = std::move(result);
+  return true;
+}
+
+bool WriteLibrarySnapshot(const std::filesystem::path &snapshot_path, const LibrarySource &source,
+                          const std::vector<LibraryItem> &items) {
+  SnapshotBuilder builder;
+  std::vector<ItemRecord> records;
+  records.reserve(items.size());
+  for (const auto &item : items) {
+    ItemRecord record{};
+    record.item_id = builder.Add(item.item_id.str());
+    record.title = builder.Add(item.title);
+    record.description = builder.Add(item.description);
+    record.icon_path = builder.Add(item.icon_path);
+    record.hero_path = builder.Add(item.hero_path);
+    record.folder = builder.Add(item.folder);
+    std::tie(record.linux_first, record.linux_count) = builder.AddArgs(item.cmd_linux);
+    std::tie(record.windows_first, record.windows_count) = builder.AddArgs(item.cmd_windows);
+    records.push_back(record);
+  }
+  if (builder.pool().size() > UINT32_MAX) {
+    return false;
+  }
+
+  SnapshotHeader header{};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.item_count = static_cast<uint32_t>(records.size());
+  header.source_size = source.size;
+  header.source_mtime = source.mtime;
+  header.source_hash = source.hash;
+  header.arg_count = static_cast<uint32_t>(builder.args().size());
+  header.pool_size = static_cast<uint32_t>(builder.pool().size());
+
+  std::string contents;
+  contents.reserve(sizeof(header) + records.size() * sizeof(ItemRecord) +
+                   builder.args().size() * sizeof(StringRef) + builder.pool().size());
+  contents.append(reinterpret_cast<const char *>(&header), sizeof(header));
+  contents.append(reinterpret_cast<const char *>(records.data()),
+                  records.size() * sizeof(ItemRecord));
+  contents.append(reinterpret_cast<const char *>(builder.args().data()),
+                  builder.args().size() * sizeof(StringRef));
+  contents.append(builder.pool());
+  return WriteFileAtomic(snapshot_path, contents);
+}
+
+}  // namespace vita::data
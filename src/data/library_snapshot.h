@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+#include <vector>
+
+#include "data/library.h"
+
+namespace vita::data {
+
+// Identity of the library.json a snapshot was compiled from. A snapshot is
+// only used when all three fields match the file on disk.
+struct LibrarySource {
+  uint64_t size = 0;
+  int64_t mtime = 0;
+  uint64_t hash = 0;
+};
+
+LibrarySource DescribeLibrarySource(const std::filesystem::path &path, std::string_view contents);
+std::filesystem::path LibrarySnapshotPath(const std::filesystem::path &json_path);
+
+// Snapshot layout: a fixed header, fixed-size item records whose strings are
+// (offset, length) references, a table of references for command arguments,
+// and one string pool. Everything is validated before any item is built.
+bool ReadLibrarySnapshot(const std::filesystem::path &snapshot_path, const LibrarySource &source,
+                         std::vector<LibraryItem> &items);
+bool WriteLibrarySnapshot(const std::filesystem::path &snapshot_path, const LibrarySource &source,
+                          const std::vector<LibraryItem> &items);
+
+}  // namespace vita::data
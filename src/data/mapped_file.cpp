@@ -0,0 +1,122 @@
+#include "data/mapped_file.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#include <fstream>
+#include <sstream>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace vita::data {
+
+MappedFile::~MappedFile() {
+  Reset();
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : open_(std::exchange(other.open_, false)),
+      mapping_(std::exchange(other.mapping_, nullptr)),
+      mapping_size_(std::exchange(other.mapping_size_, 0)),
+      buffer_(std::move(other.buffer_)) {}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+  if (this != &other) {
+    Reset();
+    open_ = std::exchange(other.open_, false);
+    mapping_ = std::exchange(other.mapping_, nullptr);
+    mapping_size_ = std::exchange(other.mapping_size_, 0);
+    buffer_ = std::move(other.buffer_);
+  }
+  return *this;
+}
+
+std::string_view MappedFile::view() const {
+  if (mapping_) {
+    return std::string_view(static_cast<const char *>(mapping_), mapping_size_);
+  }
+  return buffer_;
+}
+
+void MappedFile::Reset() {
+#ifndef _WIN32
+  if (mapping_) {
+    munmap(mapping_, mapping_size_);
+  }
+#endif
+  mapping_ = nullptr;
+  mapping_size_ = 0;
+  buffer_.clear();
+  open_ = false;
+}
+
+#ifdef _WIN32
+
+MappedFile MappedFile::Open(const std::filesystem::path &path) {
+  MappedFile file;
+  std::ifstream stream(path, std::ios::binary);
+  if (!stream.is_open()) {
+    return file;
+  }
+  std::ostringstream buffer;
+  buffer << stream.rdbuf();
+  file.buffer_ = buffer.str();
+  file.open_ = true;
+  return file;
+}
+
+#else
+
+MappedFile MappedFile::Open(const std::filesystem::path &path) {
+  MappedFile file;
+  const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return file;
+  }
+  struct stat info {};
+  const bool regular = fstat(fd, &info) == 0 && S_ISREG(info.st_mode);
+  const size_t size = regular ? static_cast<size_t>(info.st_size) : 0;
+  if (regular && size >= kMapThreshold) {
+    void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping != MAP_FAILED) {
+      madvise(mapping, size, MADV_SEQUENTIAL);
+      file.mapping_ = mapping;
+      file.mapping_size_ = size;
+      file.open_ = true;
+      ::close(fd);
+      return file;
+    }
+  }
+  file.buffer_.resize(regular ? size : kMapThreshold);
+  size_t length = 0;
+  while (true) {
+    if (length == file.buffer_.size()) {
+      file.buffer_.resize(file.buffer_.size() * 2 + 1);
+    }
+    const ssize_t count = ::read(fd, file.buffer_.data() + length, file.buffer_.size() - length);
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      ::close(fd);
+      return MappedFile{};
+    }
+    if (count == 0) {
+      break;
+    }
+    length += static_cast<size_t>(count);
+  }
+  file.buffer_.resize(length);
+  file.open_ = true;
+  ::close(fd);
+  return file;
+}
+
+#endif
+
+}  // namespace vita::data
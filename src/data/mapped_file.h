@@ -0,0 +1,40 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+namespace vita::data {
+
+// Read-only view of a whole file for the parsers. Regular files of at least
+// kMapThreshold bytes are mmap'd so parsing starts straight from the page
+// cache; smaller files, pipes and platforms without mmap are read into an
+// owned buffer with one read() loop. Views handed out by the parsers may
+// point into this buffer, so keep the MappedFile alive while using them.
+class MappedFile {
+ public:
+  static constexpr size_t kMapThreshold = 64 * 1024;
+
+  MappedFile() = default;
+  ~MappedFile();
+  MappedFile(MappedFile &&other) noexcept;
+  MappedFile &operator=(MappedFile &&other) noexcept;
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  static MappedFile Open(const std::filesystem::path &path);
+
+  bool is_open() const { return open_; }
+  bool is_mapped() const { return mapping_ != nullptr; }
+  std::string_view view() const;
+
+ private:
+  bool open_ = false;
+  void *mapping_ = nullptr;
+  size_t mapping_size_ = 0;
+  std::string buffer_;
+
+  void Reset();
+};
+
+}  // namespace vita::data
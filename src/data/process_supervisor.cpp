@@ -0,0 +1,207 @@
+#include "data/process_supervisor.h"
+
+#include <utility>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+extern char **environ;
+#endif
+
+namespace vita::data {
+
+#ifndef _WIN32
+
+namespace {
+
+int g_sigchld_fd = -1;
+struct sigaction g_previous_sigchld;
+
+extern "C" void HandleSigchld(int /*signal*/) {
+  const int saved_errno = errno;
+  const char byte = 0;
+  // Non-blocking: a full pipe already guarantees a wakeup.
+  [[maybe_unused]] const ssize_t written = ::write(g_sigchld_fd, &byte, 1);
+  errno = saved_errno;
+}
+
+bool OpenPipe(int fds[2]) {
+  if (::pipe(fds) != 0) {
+    return false;
+  }
+  for (int index = 0; index < 2; ++index) {
+    ::fcntl(fds[index], F_SETFD, FD_CLOEXEC);
+    ::fcntl(fds[index], F_SETFL, ::fcntl(fds[index], F_GETFL) | O_NONBLOCK);
+  }
+  return true;
+}
+
+void ClosePipe(int fds[2]) {
+  for (int index = 0; index < 2; ++index) {
+    if (fds[index] >= 0) {
+      ::close(fds[index]);
+      fds[index] = -1;
+    }
+  }
+}
+
+void Drain(int fd) {
+  char buffer[64];
+  while (::read(fd, buffer, sizeof(buffer)) > 0) {
+  }
+}
+
+}  // namespace
+
+ProcessSupervisor::ProcessSupervisor(std::function<void()> on_exit)
+    : on_exit_(std::move(on_exit)) {
+  if (!OpenPipe(signal_fds_) || !OpenPipe(stop_fds_)) {
+    ClosePipe(signal_fds_);
+    ClosePipe(stop_fds_);
+    return;
+  }
+  g_sigchld_fd = signal_fds_[1];
+  struct sigaction action {};
+  action.sa_handler = HandleSigchld;
+  sigemptyset(&action.sa_mask);
+  action.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+  ::sigaction(SIGCHLD, &action, &g_previous_sigchld);
+  watcher_ = std::thread([this] { Watch(); });
+}
+
+ProcessSupervisor::~ProcessSupervisor() {
+  if (watcher_.joinable()) {
+    const char byte = 0;
+    [[maybe_unused]] const ssize_t written = ::write(stop_fds_[1], &byte, 1);
+    watcher_.join();
+    ::sigaction(SIGCHLD, &g_previous_sigchld, nullptr);
+    g_sigchld_fd = -1;
+  }
+  // Titles still running are left alone; they outlive the shell.
+  ClosePipe(signal_fds_);
+  ClosePipe(stop_fds_);
+}
+
+void ProcessSupervisor::Watch() {
+  while (true) {
+    pollfd fds[2] = {{signal_fds_[0], POLLIN, 0}, {stop_fds_[0], POLLIN, 0}};
+    if (::poll(fds, 2, -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return;
+    }
+    if (fds[1].revents != 0) {
+      return;
+    }
+    if (fds[0].revents != 0) {
+      Drain(signal_fds_[0]);
+      if (on_exit_) {
+        on_exit_();
+      }
+    }
+  }
+}
+
+bool ProcessSupervisor::Launch(ItemId item, const std::vector<std::string> &argv,
+                               std::string &error) {
+  if (!watcher_.joinable()) {
+    error = "process supervisor unavailable";
+    return false;
+  }
+  if (argv.empty()) {
+    error = "no command";
+    return false;
+  }
+  if (IsRunning(item)) {
+    error = "already running";
+    return false;
+  }
+  std::vector<char *> args;
+  args.reserve(argv.size() + 1);
+  for (const auto &arg : argv) {
+    args.push_back(const_cast<char *>(arg.c_str()));
+  }
+  args.push_back(nullptr);
+
+  // The child starts with no blocked signals and default handlers for the
+  // ones the shell changes, whatever thread happens to spawn it.
+  posix_spawnattr_t attributes;
+  posix_spawnattr_init(&attributes);
+  sigset_t mask;
+  sigemptyset(&mask);
+  posix_spawnattr_setsigmask(&attributes, &mask);
+  sigset_t defaults;
+  sigemptyset(&defaults);
+  sigaddset(&defaults, SIGCHLD);
+  sigaddset(&defaults, SIGPIPE);
+  posix_spawnattr_setsigdefault(&attributes, &defaults);
+  posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+
+  pid_t pid = 0;
+  const int result = ::posix_spawnp(&pid, args[0], nullptr, &attributes, args.data(), environ);
+  posix_spawnattr_destroy(&attributes);
+  if (result != 0) {
+    error = std::strerror(result);
+    return false;
+  }
+  children_[item] = {static_cast<int>(pid), std::chrono::steady_clock::now()};
+  return true;
+}
+
+std::vector<ProcessSupervisor::Exit> ProcessSupervisor::Reap() {
+  std::vector<Exit> exits;
+  for (auto iter = children_.begin(); iter != children_.end();) {
+    int status = 0;
+    const pid_t result = ::waitpid(iter->second.pid, &status, WNOHANG);
+    if (result == 0 || (result < 0 && errno == EINTR)) {
+      ++iter;
+      continue;
+    }
+    Exit exit;
+    exit.item = iter->first;
+    exit.pid = iter->second.pid;
+    exit.runtime_s =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - iter->second.started)
+            .count();
+    if (result < 0) {
+      exit.exit_code = -1;  // reaped elsewhere; the status is lost
+    } else if (WIFSIGNALED(status)) {
+      exit.signal = WTERMSIG(status);
+    } else {
+      exit.exit_code = WEXITSTATUS(status);
+    }
+    exits.push_back(exit);
+    iter = children_.erase(iter);
+  }
+  return exits;
+}
+
+#else
+
+ProcessSupervisor::ProcessSupervisor(std::function<void()> on_exit)
+    : on_exit_(std::move(on_exit)) {}
+
+ProcessSupervisor::~ProcessSupervisor() = default;
+
+void ProcessSupervisor::Watch() {}
+
+bool ProcessSupervisor::Launch(ItemId /*item*/, const std::vector<std::string> & /*argv*/,
+                               std::string &error) {
+  error = "launching is not supported on this platform";
+  return false;
+}
+
+std::vector<ProcessSupervisor::Exit> ProcessSupervisor::Reap() { return {}; }
+
+#endif
+
+}  // namespace vita::data
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "data/item_id.h"
+
+namespace vita::data {
+
+// Runs titles as child processes without blocking the render thread.
+// Launch() spawns the argv vector directly with posix_spawnp, so there is no
+// shell in between and arguments containing spaces arrive intact. A SIGCHLD
+// handler writes to a self-pipe; a watcher thread blocks on it and calls
+// `on_exit` so a sleeping main loop can wake up and Reap() the children.
+// The supervisor owns the process-wide SIGCHLD handler, so only one may
+// exist at a time. On platforms without posix_spawn Launch() always fails.
+class ProcessSupervisor {
+ public:
+  struct Exit {
+    ItemId item;
+    int pid = 0;
+    int exit_code = 0;  // meaningful when signal is 0
+    int signal = 0;     // terminating signal, or 0 for a normal exit
+    double runtime_s = 0.0;
+  };
+
+  // `on_exit` runs on the watcher thread after a child has exited.
+  explicit ProcessSupervisor(std::function<void()> on_exit = {});
+  ~ProcessSupervisor();
+
+  ProcessSupervisor(const ProcessSupervisor &) = delete;
+  ProcessSupervisor &operator=(const ProcessSupervisor &) = delete;
+
+  // Starts `argv` for `item`. Fails, describing why in `error`, when the
+  // item is already running or the program could not be started.
+  bool Launch(ItemId item, const std::vector<std::string> &argv, std::string &error);
+  bool IsRunning(ItemId item) const { return children_.count(item) != 0; }
+  size_t running_count() const { return children_.size(); }
+  // Collects children that have exited since the last call; never blocks.
+  std::vector<Exit> Reap();
+
+ private:
+  struct Child {
+    int pid = 0;
+    std::chrono::steady_clock::time_point started;
+  };
+
+  void Watch();
+
+  std::function<void()> on_exit_;
+  std::unordered_map<ItemId, Child> children_;
+  int signal_fds_[2] = {-1, -1};
+  int stop_fds_[2] = {-1, -1};
+  std::thread watcher_;
+};
+
+}  // namespace vita::data
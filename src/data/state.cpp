@@ -1,192 +1,699 @@
 #include "data/state.h"
 
 #include <algorithm>
-#include <fstream>
-#include <sstream>
+#include <charconv>
+#include <optional>
 #include <stdexcept>
+#include <system_error>
+#include <unordered_set>
+#include <utility>
 
+#include "data/file_util.h"
 #include "data/json.h"
+#include "data/mapped_file.h"
 #include "ui/constants.h"
 
 namespace vita::data {
 
+void RuntimeState::MarkDirty() {
+  RebuildPlacements();
+  ++revision;
+  snapshot_required = true;
+}
+
+void RuntimeState::RebuildPlacements() {
+  placements_.clear();
+  for (size_t page = 0; page < pages.size(); ++page) {
+    auto &entries = pages[page];
+    size_t kept = 0;
+    for (ItemId entry : entries) {
+      const Placement placement{ItemId(), static_cast<uint32_t>(page), static_cast<uint32_t>(kept)};
+      if (entry.valid() && placements_.emplace(entry, placement).second) {
+        entries[kept++] = entry;
+      }
+    }
+    entries.resize(kept);
+  }
+  for (auto &[folder, items] : folders) {
+    size_t kept = 0;
+    for (ItemId item : items) {
+      const Placement placement{folder, 0, static_cast<uint32_t>(kept)};
+      if (item.valid() && !item.is_folder() && placements_.emplace(item, placement).second) {
+        items[kept++] = item;
+      }
+    }
+    items.resize(kept);
+  }
+}
+
+const Placement *RuntimeState::Find(ItemId id) const {
+  const auto iter = placements_.find(id);
+  return iter == placements_.end() ? nullptr : &iter->second;
+}
+
 void RuntimeState::EnsureLimits(size_t library_count) const {
   if (pages.size() > static_cast<size_t>(ui::kMaxPages)) {
     throw std::runtime_error("Too many pages");
   }
-  size_t icon_count = 0;
-  for (const auto &page : pages) {
-    icon_count += page.size();
+  if (icon_count() > static_cast<size_t>(ui::kMaxIcons) || icon_count() > library_count) {
+    throw std::runtime_error("Too many icons");
+  }
+}
+
+std::vector<ItemId> &RuntimeState::Container(const Placement &placement) {
+  return placement.folder.valid() ? folders[placement.folder] : pages[placement.page];
+}
+
+void RuntimeState::Renumber(const Placement &placement, size_t from) {
+  const auto &entries = Container(placement);
+  for (size_t slot = from; slot < entries.size(); ++slot) {
+    placements_[entries[slot]].slot = static_cast<uint32_t>(slot);
   }
-  for (const auto &entry : folders) {
-    icon_count += entry.second.size();
+}
+
+void RuntimeState::Attach(ItemId id, Placement placement) {
+  auto &entries = Container(placement);
+  const size_t slot = std::min<size_t>(placement.slot, entries.size());
+  entries.insert(entries.begin() + static_cast<std::ptrdiff_t>(slot), id);
+  placement.slot = static_cast<uint32_t>(slot);
+  placements_[id] = placement;
+  Renumber(placement, slot + 1);
+}
+
+void RuntimeState::Detach(ItemId id) {
+  const auto iter = placements_.find(id);
+  if (iter == placements_.end()) {
+    return;
   }
-  if (icon_count > static_cast<size_t>(ui::kMaxIcons) || icon_count > library_count) {
-    throw std::runtime_error("Too many icons");
+  const Placement placement = iter->second;
+  placements_.erase(iter);
+  auto &entries = Container(placement);
+  entries.erase(entries.begin() + placement.slot);
+  Renumber(placement, placement.slot);
+}
+
+void RuntimeState::DropIfEmpty(ItemId folder) {
+  const auto iter = folders.find(folder);
+  if (iter != folders.end() && iter->second.empty()) {
+    folders.erase(iter);
+    Detach(folder);
   }
 }
 
-void RuntimeState::AddFolder(const std::string &name) {
-  if (folders.find(name) == folders.end()) {
-    folders.emplace(name, std::vector<std::string>{});
+void RuntimeState::AddFolder(ItemId folder) {
+  if (!folder.is_folder()) {
+    throw std::runtime_error("Not a folder id");
+  }
+  if (folders.try_emplace(folder).second) {
+    StateMutation mutation;
+    mutation.kind = StateMutation::Kind::kAddFolder;
+    mutation.folder = folder;
+    Record(std::move(mutation));
   }
 }
 
-void RuntimeState::AddToFolder(const std::string &folder, const std::string &item_id) {
-  if (item_id.rfind("folder:", 0) == 0) {
+void RuntimeState::AddToFolder(ItemId folder, ItemId item_id) {
+  if (item_id.is_folder()) {
     throw std::runtime_error("Folder nesting is not allowed");
   }
-  AddFolder(folder);
-  auto &items = folders[folder];
-  if (std::find(items.begin(), items.end(), item_id) == items.end()) {
-    items.push_back(item_id);
+  if (!folder.is_folder()) {
+    throw std::runtime_error("Not a folder id");
   }
+  const Placement *current = Find(item_id);
+  if (current && current->folder == folder) {
+    return;
+  }
+  const ItemId previous_folder = current ? current->folder : ItemId();
+  Detach(item_id);
+  Attach(item_id, {folder, 0, static_cast<uint32_t>(folders[folder].size())});
+  if (previous_folder.valid()) {
+    DropIfEmpty(previous_folder);
+  }
+  StateMutation mutation;
+  mutation.kind = StateMutation::Kind::kAddToFolder;
+  mutation.folder = folder;
+  mutation.item = item_id;
+  Record(std::move(mutation));
 }
 
-void RuntimeState::RemoveFromFolder(const std::string &folder, const std::string &item_id) {
-  auto iter = folders.find(folder);
-  if (iter == folders.end()) {
+void RuntimeState::RemoveFromFolder(ItemId folder, ItemId item_id) {
+  const Placement *current = Find(item_id);
+  if (!current || current->folder != folder) {
     return;
   }
-  auto &items = iter->second;
-  items.erase(std::remove(items.begin(), items.end(), item_id), items.end());
-  if (items.empty()) {
-    folders.erase(iter);
-    for (auto &page : pages) {
-      page.erase(
-          std::remove(page.begin(), page.end(), std::string("folder:") + folder),
-          page.end());
+  // The icon goes back onto the folder's page, or the last page when the
+  // folder is not on one, so it stays in the layout.
+  const Placement *folder_placement = Find(folder);
+  if (pages.empty()) {
+    pages.emplace_back();
+  }
+  const uint32_t page =
+      folder_placement ? folder_placement->page : static_cast<uint32_t>(pages.size() - 1);
+  Detach(item_id);
+  Attach(item_id, {ItemId(), page, static_cast<uint32_t>(pages[page].size())});
+  DropIfEmpty(folder);
+  StateMutation mutation;
+  mutation.kind = StateMutation::Kind::kRemoveFromFolder;
+  mutation.folder = folder;
+  mutation.item = item_id;
+  Record(std::move(mutation));
+}
+
+void RuntimeState::MoveEntry(ItemId entry, size_t page, size_t slot) {
+  if (page >= static_cast<size_t>(ui::kMaxPages)) {
+    throw std::runtime_error("Too many pages");
+  }
+  const Placement *current = Find(entry);
+  const ItemId previous_folder = current ? current->folder : ItemId();
+  Detach(entry);
+  if (pages.size() <= page) {
+    pages.resize(page + 1);
+  }
+  Attach(entry, {ItemId(), static_cast<uint32_t>(page), static_cast<uint32_t>(slot)});
+  if (previous_folder.valid()) {
+    DropIfEmpty(previous_folder);
+  }
+  StateMutation mutation;
+  mutation.kind = StateMutation::Kind::kMoveEntry;
+  mutation.item = entry;
+  mutation.page = page;
+  mutation.slot = slot;
+  Record(std::move(mutation));
+}
+
+void RuntimeState::RemoveEntry(ItemId entry) {
+  const Placement *current = Find(entry);
+  if (!current) {
+    return;
+  }
+  const ItemId previous_folder = current->folder;
+  Detach(entry);
+  if (previous_folder.valid()) {
+    DropIfEmpty(previous_folder);
+  }
+  if (entry.is_folder()) {
+    const auto iter = folders.find(entry);
+    if (iter != folders.end()) {
+      for (ItemId item : iter->second) {
+        placements_.erase(item);
+      }
+      folders.erase(iter);
     }
   }
+  StateMutation mutation;
+  mutation.kind = StateMutation::Kind::kRemoveEntry;
+  mutation.item = entry;
+  Record(std::move(mutation));
+}
+
+void RuntimeState::SetCurrentPage(int page) {
+  if (page == current_page) {
+    return;
+  }
+  current_page = page;
+  StateMutation mutation;
+  mutation.kind = StateMutation::Kind::kSetPage;
+  mutation.page = static_cast<size_t>(page);
+  Record(std::move(mutation));
+}
+
+void RuntimeState::TouchLastPlayed(ItemId item_id, double timestamp) {
+  last_played[item_id] = timestamp;
+  StateMutation mutation;
+  mutation.kind = StateMutation::Kind::kLastPlayed;
+  mutation.item = item_id;
+  mutation.timestamp = timestamp;
+  Record(std::move(mutation));
+}
+
+void RuntimeState::PushNotification(Notification note) {
+  StateMutation mutation;
+  mutation.kind = StateMutation::Kind::kPushNotification;
+  mutation.item = note.item_id;
+  mutation.message = note.message;
+  notifications.push_back(std::move(note));
+  Record(std::move(mutation));
+}
+
+void RuntimeState::ClearNotifications() {
+  if (notifications.empty()) {
+    return;
+  }
+  notifications.clear();
+  StateMutation mutation;
+  mutation.kind = StateMutation::Kind::kClearNotifications;
+  Record(std::move(mutation));
+}
+
+void RuntimeState::Apply(const StateMutation &mutation) {
+  switch (mutation.kind) {
+    case StateMutation::Kind::kAddFolder:
+      AddFolder(mutation.folder);
+      break;
+    case StateMutation::Kind::kAddToFolder:
+      AddToFolder(mutation.folder, mutation.item);
+      break;
+    case StateMutation::Kind::kRemoveFromFolder:
+      RemoveFromFolder(mutation.folder, mutation.item);
+      break;
+    case StateMutation::Kind::kMoveEntry:
+      MoveEntry(mutation.item, mutation.page, mutation.slot);
+      break;
+    case StateMutation::Kind::kRemoveEntry:
+      RemoveEntry(mutation.item);
+      break;
+    case StateMutation::Kind::kLastPlayed:
+      TouchLastPlayed(mutation.item, mutation.timestamp);
+      break;
+    case StateMutation::Kind::kPushNotification:
+      PushNotification({mutation.message, mutation.item});
+      break;
+    case StateMutation::Kind::kClearNotifications:
+      ClearNotifications();
+      break;
+    case StateMutation::Kind::kSetPage:
+      SetCurrentPage(static_cast<int>(mutation.page));
+      break;
+  }
+}
+
+void RuntimeState::Record(StateMutation mutation) {
+  journal.push_back(std::move(mutation));
+  ++revision;
+}
+
+static constexpr std::string_view kFolderPrefix = "folder:";
+
+static ItemId ParsePageEntry(std::string_view entry) {
+  if (entry.substr(0, kFolderPrefix.size()) == kFolderPrefix) {
+    return ItemId::InternFolder(entry.substr(kFolderPrefix.size()));
+  }
+  return ItemId::Intern(entry);
+}
+
+static void WritePageEntry(JsonWriter &writer, ItemId id) {
+  if (id.is_folder()) {
+    writer.WriteString(std::string(kFolderPrefix) + id.str());
+  } else {
+    writer.WriteString(id.str());
+  }
+}
+
+static void WriteIdArray(JsonWriter &writer, const std::vector<ItemId> &items) {
+  writer.BeginArray();
+  for (ItemId item : items) {
+    WritePageEntry(writer, item);
+  }
+  writer.EndArray();
 }
 
-static JsonValue ToJson(const RuntimeState &state) {
-  JsonValue::Object root;
-  root["current_page"] = JsonValue(static_cast<double>(state.current_page));
+static void ToJson(const RuntimeState &state, JsonWriter &writer) {
+  writer.BeginObject();
+  writer.WriteKey("current_page");
+  writer.WriteNumber(static_cast<double>(state.current_page));
 
-  JsonValue::Array pages;
+  writer.WriteKey("pages");
+  writer.BeginArray();
   for (const auto &page : state.pages) {
-    JsonValue::Array page_array;
-    for (const auto &item : page) {
-      page_array.emplace_back(item);
-    }
-    pages.emplace_back(page_array);
+    WriteIdArray(writer, page);
   }
-  root["pages"] = JsonValue(pages);
+  writer.EndArray();
 
-  JsonValue::Object folders;
+  writer.WriteKey("folders");
+  writer.BeginObject();
   for (const auto &entry : state.folders) {
-    JsonValue::Array items;
-    for (const auto &item : entry.second) {
-      items.emplace_back(item);
-    }
-    folders[entry.first] = JsonValue(items);
+    writer.WriteKey(entry.first.str());
+    WriteIdArray(writer, entry.second);
   }
-  root["folders"] = JsonValue(folders);
+  writer.EndObject();
 
-  JsonValue::Object backgrounds;
+  writer.WriteKey("backgrounds");
+  writer.BeginObject();
   for (const auto &entry : state.page_backgrounds) {
-    backgrounds[std::to_string(entry.first)] = JsonValue(entry.second);
+    writer.WriteKey(std::to_string(entry.first));
+    writer.WriteString(entry.second);
   }
-  root["backgrounds"] = JsonValue(backgrounds);
+  writer.EndObject();
 
-  JsonValue::Array notifications;
+  writer.WriteKey("notifications");
+  writer.BeginArray();
   for (const auto &note : state.notifications) {
-    JsonValue::Object note_obj;
-    note_obj["message"] = JsonValue(note.message);
-    note_obj["item_id"] = JsonValue(note.item_id);
-    notifications.emplace_back(note_obj);
+    writer.BeginObject();
+    writer.WriteKey("message");
+    writer.WriteString(note.message);
+    writer.WriteKey("item_id");
+    writer.WriteString(note.item_id.str());
+    writer.EndObject();
   }
-  root["notifications"] = JsonValue(notifications);
+  writer.EndArray();
 
-  JsonValue::Object last_played;
+  writer.WriteKey("last_played");
+  writer.BeginObject();
   for (const auto &entry : state.last_played) {
-    last_played[entry.first] = JsonValue(entry.second);
-  }
-  root["last_played"] = JsonValue(last_played);
-
-  JsonValue::Array open_liveareas;
-  for (const auto &item : state.open_liveareas) {
-    open_liveareas.emplace_back(item);
+    writer.WriteKey(entry.first.str());
+    writer.WriteNumber(entry.second);
   }
-  root["open_liveareas"] = JsonValue(open_liveareas);
+  writer.EndObject();
 
-  return JsonValue(root);
+  writer.WriteKey("open_liveareas");
+  WriteIdArray(writer, state.open_liveareas);
+  writer.EndObject();
 }
 
-static RuntimeState FromJson(const JsonValue &root) {
-  RuntimeState state;
-  if (const auto *current = root.Find("current_page")) {
-    state.current_page = static_cast<int>(current->AsNumber(0));
-  }
-  if (const auto *pages_value = root.Find("pages")) {
-    for (const auto &page_value : pages_value->AsArray()) {
-      std::vector<std::string> page;
-      for (const auto &entry : page_value.AsArray()) {
-        page.push_back(entry.AsString(""));
+static std::vector<ItemId> ReadIdArray(JsonReader &reader) {
+  std::vector<ItemId> result;
+  if (reader.BeginArray()) {
+    while (reader.NextElement()) {
+      const ItemId id = ParsePageEntry(reader.ReadStringView());
+      if (id.valid()) {
+        result.push_back(id);
       }
-      state.pages.push_back(std::move(page));
     }
   }
-  if (const auto *folders_value = root.Find("folders")) {
-    for (const auto &entry : folders_value->AsObject()) {
-      std::vector<std::string> items;
-      for (const auto &item : entry.second.AsArray()) {
-        items.push_back(item.AsString(""));
-      }
-      state.folders.emplace(entry.first, std::move(items));
-    }
+  return result;
+}
+
+static Notification ReadNotification(JsonReader &reader) {
+  Notification note;
+  if (!reader.BeginObject()) {
+    return note;
   }
-  if (const auto *backgrounds_value = root.Find("backgrounds")) {
-    for (const auto &entry : backgrounds_value->AsObject()) {
-      state.page_backgrounds.emplace(std::stoi(entry.first), entry.second.AsString(""));
+  std::string_view key;
+  while (reader.NextMember(key)) {
+    if (key == "message") {
+      note.message = reader.ReadString("");
+    } else if (key == "item_id") {
+      note.item_id = ItemId::Intern(reader.ReadStringView());
+    } else {
+      reader.Skip();
     }
   }
-  if (const auto *notifications_value = root.Find("notifications")) {
-    for (const auto &entry : notifications_value->AsArray()) {
-      Notification note;
-      if (const auto *message = entry.Find("message")) {
-        note.message = message->AsString("");
+  return note;
+}
+
+// state.json written before placements became exclusive kept foldered items
+// on their page as well. The folder copy wins: page copies are removed, then
+// folders left empty are dropped along with their page entries. Returns true
+// when anything changed.
+static bool MigrateSharedPlacements(RuntimeState &state) {
+  std::unordered_set<ItemId> foldered;
+  for (const auto &entry : state.folders) {
+    foldered.insert(entry.second.begin(), entry.second.end());
+  }
+  bool changed = false;
+  for (auto &page : state.pages) {
+    const size_t before = page.size();
+    page.erase(std::remove_if(page.begin(), page.end(),
+                              [&foldered](ItemId entry) {
+                                return !entry.is_folder() && foldered.count(entry) != 0;
+                              }),
+               page.end());
+    changed |= page.size() != before;
+  }
+  state.RebuildPlacements();
+  for (auto iter = state.folders.begin(); iter != state.folders.end();) {
+    iter = iter->second.empty() ? state.folders.erase(iter) : std::next(iter);
+  }
+  for (auto &page : state.pages) {
+    const size_t before = page.size();
+    page.erase(std::remove_if(page.begin(), page.end(),
+                              [&state](ItemId entry) {
+                                return entry.is_folder() && state.folders.count(entry) == 0;
+                              }),
+               page.end());
+    changed |= page.size() != before;
+  }
+  return changed;
+}
+
+static RuntimeState FromJson(JsonReader &reader) {
+  RuntimeState state;
+  if (!reader.BeginObject()) {
+    return state;
+  }
+  std::string_view key;
+  while (reader.NextMember(key)) {
+    if (key == "current_page") {
+      state.current_page = static_cast<int>(reader.ReadNumber(0));
+    } else if (key == "pages") {
+      if (reader.BeginArray()) {
+        while (reader.NextElement()) {
+          state.pages.push_back(ReadIdArray(reader));
+        }
       }
-      if (const auto *item_id = entry.Find("item_id")) {
-        note.item_id = item_id->AsString("");
+    } else if (key == "folders") {
+      if (reader.BeginObject()) {
+        std::string_view name;
+        while (reader.NextMember(name)) {
+          const ItemId folder = ItemId::InternFolder(name);
+          std::vector<ItemId> items = ReadIdArray(reader);
+          if (folder.valid()) {
+            state.folders.emplace(folder, std::move(items));
+          }
+        }
       }
-      state.notifications.push_back(std::move(note));
+    } else if (key == "backgrounds") {
+      if (reader.BeginObject()) {
+        std::string_view page;
+        while (reader.NextMember(page)) {
+          const int index = std::stoi(std::string(page));
+          state.page_backgrounds.emplace(index, reader.ReadString(""));
+        }
+      }
+    } else if (key == "notifications") {
+      if (reader.BeginArray()) {
+        while (reader.NextElement()) {
+          state.notifications.push_back(ReadNotification(reader));
+        }
+      }
+    } else if (key == "last_played") {
+      if (reader.BeginObject()) {
+        std::string_view item_id;
+        while (reader.NextMember(item_id)) {
+          const ItemId id = ItemId::Intern(item_id);
+          const double timestamp = reader.ReadNumber(0.0);
+          if (id.valid()) {
+            state.last_played.emplace(id, timestamp);
+          }
+        }
+      }
+    } else if (key == "open_liveareas") {
+      state.open_liveareas = ReadIdArray(reader);
+    } else {
+      reader.Skip();
     }
   }
-  if (const auto *last_played_value = root.Find("last_played")) {
-    for (const auto &entry : last_played_value->AsObject()) {
-      state.last_played.emplace(entry.first, entry.second.AsNumber(0.0));
-    }
+  if (MigrateSharedPlacements(state)) {
+    state.snapshot_required = true;
   }
-  if (const auto *open_value = root.Find("open_liveareas")) {
-    for (const auto &entry : open_value->AsArray()) {
-      state.open_liveareas.push_back(entry.AsString(""));
+  state.RebuildPlacements();
+  return state;
+}
+
+// Journal records are one compact JSON array per line, e.g.
+// ["move","folder:Games",0,3]. The first line names the hash of the snapshot
+// the records apply to, so a journal left behind by an interrupted compaction
+// is recognised as stale and ignored.
+static constexpr std::string_view kJournalHeader = "journal";
+
+static std::string_view MutationName(StateMutation::Kind kind) {
+  switch (kind) {
+    case StateMutation::Kind::kAddFolder:
+      return "add_folder";
+    case StateMutation::Kind::kAddToFolder:
+      return "add_to_folder";
+    case StateMutation::Kind::kRemoveFromFolder:
+      return "remove_from_folder";
+    case StateMutation::Kind::kMoveEntry:
+      return "move";
+    case StateMutation::Kind::kRemoveEntry:
+      return "remove";
+    case StateMutation::Kind::kLastPlayed:
+      return "played";
+    case StateMutation::Kind::kPushNotification:
+      return "notify";
+    case StateMutation::Kind::kClearNotifications:
+      return "clear_notifications";
+    case StateMutation::Kind::kSetPage:
+      return "page";
+  }
+  return "";
+}
+
+static std::optional<StateMutation> ReadMutation(JsonReader &reader) {
+  if (!reader.BeginArray() || !reader.NextElement()) {
+    return std::nullopt;
+  }
+  const std::string name(reader.ReadStringView());
+  StateMutation mutation;
+  auto next_string = [&reader]() -> std::string_view {
+    return reader.NextElement() ? reader.ReadStringView() : std::string_view();
+  };
+  auto next_number = [&reader]() { return reader.NextElement() ? reader.ReadNumber(0.0) : 0.0; };
+  if (name == "add_folder") {
+    mutation.kind = StateMutation::Kind::kAddFolder;
+    mutation.folder = ItemId::InternFolder(next_string());
+  } else if (name == "add_to_folder" || name == "remove_from_folder") {
+    mutation.kind = name == "add_to_folder" ? StateMutation::Kind::kAddToFolder
+                                            : StateMutation::Kind::kRemoveFromFolder;
+    mutation.folder = ItemId::InternFolder(next_string());
+    mutation.item = ItemId::Intern(next_string());
+  } else if (name == "move") {
+    mutation.kind = StateMutation::Kind::kMoveEntry;
+    mutation.item = ParsePageEntry(next_string());
+    mutation.page = static_cast<size_t>(next_number());
+    mutation.slot = static_cast<size_t>(next_number());
+  } else if (name == "remove") {
+    mutation.kind = StateMutation::Kind::kRemoveEntry;
+    mutation.item = ParsePageEntry(next_string());
+  } else if (name == "played") {
+    mutation.kind = StateMutation::Kind::kLastPlayed;
+    mutation.item = ItemId::Intern(next_string());
+    mutation.timestamp = next_number();
+  } else if (name == "notify") {
+    mutation.kind = StateMutation::Kind::kPushNotification;
+    mutation.message = std::string(next_string());
+    mutation.item = ItemId::Intern(next_string());
+  } else if (name == "clear_notifications") {
+    mutation.kind = StateMutation::Kind::kClearNotifications;
+  } else if (name == "page") {
+    mutation.kind = StateMutation::Kind::kSetPage;
+    mutation.page = static_cast<size_t>(next_number());
+  } else {
+    return std::nullopt;
+  }
+  while (reader.NextElement()) {
+    reader.Skip();
+  }
+  return mutation;
+}
+
+// Applies complete journal lines to `state`. Returns false when the journal
+// is missing, stale, or ends in a torn or unreadable record, in which case
+// the next save must rewrite the snapshot before appending again.
+static bool ReplayJournal(std::string_view journal, std::string_view expected_header,
+                          RuntimeState &state) {
+  const size_t header_end = journal.find('\n');
+  if (header_end == std::string_view::npos ||
+      journal.substr(0, header_end) != expected_header) {
+    return false;
+  }
+  size_t pos = header_end + 1;
+  while (pos < journal.size()) {
+    const size_t line_end = journal.find('\n', pos);
+    if (line_end == std::string_view::npos) {
+      return false;
+    }
+    try {
+      JsonReader reader(journal.substr(pos, line_end - pos));
+      const std::optional<StateMutation> mutation = ReadMutation(reader);
+      if (!mutation) {
+        return false;
+      }
+      state.Apply(*mutation);
+    } catch (const std::exception &) {
+      return false;
     }
+    pos = line_end + 1;
   }
-  return state;
+  return true;
 }
 
-StateStore::StateStore(std::filesystem::path path) : path_(std::move(path)) {}
+StateStore::StateStore(std::filesystem::path path) : path_(std::move(path)) {
+  journal_path_ = path_;
+  journal_path_ += ".journal";
+}
 
 RuntimeState StateStore::Load() const {
-  std::ifstream file(path_);
+  const MappedFile file = MappedFile::Open(path_);
   if (!file.is_open()) {
-    return RuntimeState{};
+    RuntimeState state;
+    state.snapshot_required = true;
+    return state;
   }
-  std::ostringstream buffer;
-  buffer << file.rdbuf();
-  JsonParser parser(buffer.str());
-  JsonValue root = parser.Parse();
-  return FromJson(root);
+  JsonReader reader(file.view());
+  RuntimeState state = FromJson(reader);
+  const MappedFile journal = MappedFile::Open(journal_path_);
+  const bool replayed =
+      journal.is_open() &&
+      ReplayJournal(journal.view(), JournalHeader(HashBytes(file.view())), state);
+  state.journal.clear();
+  state.revision = 0;
+  state.snapshot_required = state.snapshot_required || !replayed;
+  return state;
 }
 
-void StateStore::Save(const RuntimeState &state) const {
-  std::ofstream file(path_);
-  if (!file.is_open()) {
-    return;
+bool StateStore::Save(const RuntimeState &state) const {
+  JsonWriter writer;
+  Serialize(state, writer);
+  return WriteSnapshot(writer.view());
+}
+
+bool StateStore::WriteSnapshot(std::string_view contents) const {
+  return WriteFileAtomic(path_, contents) &&
+         WriteFileAtomic(journal_path_, JournalHeader(HashBytes(contents)) + '\n');
+}
+
+bool StateStore::AppendJournal(std::string_view records) const {
+  return AppendFile(journal_path_, records);
+}
+
+uintmax_t StateStore::JournalSize() const {
+  std::error_code error;
+  const uintmax_t size = std::filesystem::file_size(journal_path_, error);
+  return error ? 0 : size;
+}
+
+void StateStore::Serialize(const RuntimeState &state, JsonWriter &writer) {
+  ToJson(state, writer);
+}
+
+void StateStore::SerializeMutation(const StateMutation &mutation, JsonWriter &writer) {
+  writer.BeginArray();
+  writer.WriteString(MutationName(mutation.kind));
+  switch (mutation.kind) {
+    case StateMutation::Kind::kAddFolder:
+      writer.WriteString(mutation.folder.str());
+      break;
+    case StateMutation::Kind::kAddToFolder:
+    case StateMutation::Kind::kRemoveFromFolder:
+      writer.WriteString(mutation.folder.str());
+      writer.WriteString(mutation.item.str());
+      break;
+    case StateMutation::Kind::kMoveEntry:
+      WritePageEntry(writer, mutation.item);
+      writer.WriteNumber(static_cast<double>(mutation.page));
+      writer.WriteNumber(static_cast<double>(mutation.slot));
+      break;
+    case StateMutation::Kind::kRemoveEntry:
+      WritePageEntry(writer, mutation.item);
+      break;
+    case StateMutation::Kind::kLastPlayed:
+      writer.WriteString(mutation.item.str());
+      writer.WriteNumber(mutation.timestamp);
+      break;
+    case StateMutation::Kind::kPushNotification:
+      writer.WriteString(mutation.message);
+      writer.WriteString(mutation.item.str());
+      break;
+    case StateMutation::Kind::kClearNotifications:
+      break;
+    case StateMutation::Kind::kSetPage:
+      writer.WriteNumber(static_cast<double>(mutation.page));
+      break;
   }
-  file << JsonStringify(ToJson(state));
+  writer.EndArray();
+}
+
+std::string StateStore::JournalHeader(uint64_t snapshot_hash) {
+  char digits[16];
+  const auto result = std::to_chars(digits, digits + sizeof(digits), snapshot_hash, 16);
+  JsonWriter writer;
+  writer.BeginArray();
+  writer.WriteString(kJournalHeader);
+  writer.WriteString(std::string_view(digits, static_cast<size_t>(result.ptr - digits)));
+  writer.EndArray();
+  return std::string(writer.view());
 }
 
 }  // namespace vita::data
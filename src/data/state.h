@@ -1,40 +1,136 @@
 #pragma once
 
+#include <cstdint>
 #include <filesystem>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
+#include "data/item_id.h"
+
 namespace vita::data {
 
+class JsonWriter;
+
 struct Notification {
   std::string message;
-  std::string item_id;
+  ItemId item_id;
+};
+
+// One journaled change to RuntimeState. Only the fields used by `kind` are
+// meaningful; `item` holds page entries (possibly folder-tagged) for kMove.
+struct StateMutation {
+  enum class Kind {
+    kAddFolder,
+    kAddToFolder,
+    kRemoveFromFolder,
+    kMoveEntry,
+    kRemoveEntry,
+    kLastPlayed,
+    kPushNotification,
+    kClearNotifications,
+    kSetPage,
+  };
+
+  Kind kind = Kind::kAddFolder;
+  ItemId folder;
+  ItemId item;
+  size_t page = 0;
+  size_t slot = 0;
+  double timestamp = 0.0;
+  std::string message;
+};
+
+// Where an icon sits: a slot on a page, or a slot inside a folder.
+struct Placement {
+  ItemId folder;  // invalid when the icon is on a page
+  uint32_t page = 0;
+  uint32_t slot = 0;
 };
 
 struct RuntimeState {
   int current_page = 0;
-  std::vector<std::vector<std::string>> pages;
-  std::unordered_map<std::string, std::vector<std::string>> folders;
+  // Page entries are item ids or folder-tagged ids; folders are keyed by
+  // their folder-tagged id. Each id appears at most once across pages and
+  // folders.
+  std::vector<std::vector<ItemId>> pages;
+  std::unordered_map<ItemId, std::vector<ItemId>> folders;
   std::unordered_map<int, std::string> page_backgrounds;
   std::vector<Notification> notifications;
-  std::unordered_map<std::string, double> last_played;
-  std::vector<std::string> open_liveareas;
+  std::unordered_map<ItemId, double> last_played;
+  std::vector<ItemId> open_liveareas;
+  // Bumped by every mutation so persistence can tell when a save is due.
+  uint64_t revision = 0;
+  // Mutations made through the methods below since persistence last drained
+  // them. Code that edits the fields directly must call MarkDirty() instead,
+  // which rebuilds the placement index and forces the next save to be a full
+  // snapshot.
+  std::vector<StateMutation> journal;
+  bool snapshot_required = false;
+
+  void MarkDirty();
+  // Re-derives the placement index from pages and folders, dropping repeated
+  // ids and nested folders.
+  void RebuildPlacements();
+  const Placement *Find(ItemId id) const;
+  size_t icon_count() const { return placements_.size(); }
 
   void EnsureLimits(size_t library_count) const;
-  void AddFolder(const std::string &name);
-  void AddToFolder(const std::string &folder, const std::string &item_id);
-  void RemoveFromFolder(const std::string &folder, const std::string &item_id);
+  void AddFolder(ItemId folder);
+  void AddToFolder(ItemId folder, ItemId item_id);
+  // Puts the icon back on the folder's page (the last page when the folder is
+  // not on one) and drops the folder once it is empty.
+  void RemoveFromFolder(ItemId folder, ItemId item_id);
+  // Moves a page entry to `slot` on `page`, removing it from wherever it was.
+  void MoveEntry(ItemId entry, size_t page, size_t slot);
+  // Takes an icon off its page or out of its folder; removing a folder entry
+  // also drops the folder's contents from the layout.
+  void RemoveEntry(ItemId entry);
+  // Switches the page shown on the home screen.
+  void SetCurrentPage(int page);
+  void TouchLastPlayed(ItemId item_id, double timestamp);
+  void PushNotification(Notification note);
+  void ClearNotifications();
+  void Apply(const StateMutation &mutation);
+
+ private:
+  // Reverse index kept in step with pages and folders so lookups, moves and
+  // limit checks never scan the whole layout; only the slots after an
+  // insert or erase within the one container touched are renumbered.
+  std::unordered_map<ItemId, Placement> placements_;
+
+  std::vector<ItemId> &Container(const Placement &placement);
+  void Renumber(const Placement &placement, size_t from);
+  void Attach(ItemId id, Placement placement);
+  void Detach(ItemId id);
+  void DropIfEmpty(ItemId folder);
+  void Record(StateMutation mutation);
 };
 
 class StateStore {
  public:
   explicit StateStore(std::filesystem::path path);
+
+  // Loads the snapshot and replays the journal recorded on top of it.
   RuntimeState Load() const;
-  void Save(const RuntimeState &state) const;
+  // Writes a full snapshot and starts a fresh journal; false on failure.
+  bool Save(const RuntimeState &state) const;
+  // Replaces the snapshot atomically, then resets the journal to a header
+  // naming the new snapshot's hash.
+  bool WriteSnapshot(std::string_view contents) const;
+  // Appends newline-terminated records produced by SerializeMutation.
+  bool AppendJournal(std::string_view records) const;
+  uintmax_t JournalSize() const;
+
+  static void Serialize(const RuntimeState &state, JsonWriter &writer);
+  static void SerializeMutation(const StateMutation &mutation, JsonWriter &writer);
 
  private:
   std::filesystem::path path_;
+  std::filesystem::path journal_path_;
+
+  static std::string JournalHeader(uint64_t snapshot_hash);
 };
 
 }  // namespace vita::data
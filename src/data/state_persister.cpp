@@ -0,0 +1,230 @@
+#include "data/state_persister.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "data/file_util.h"
+
+namespace vita::data {
+
+StatePersister::StatePersister(StateStore store, const RuntimeState &state, int debounce_ms,
+                               int max_delay_ms)
+    : store_(std::move(store)),
+      debounce_(debounce_ms),
+      max_delay_(max_delay_ms),
+      seen_revision_(state.revision),
+      submitted_revision_(state.revision),
+      journal_bytes_(store_.JournalSize()),
+      worker_(&StatePersister::Run, this) {
+  stats_.journal_bytes = journal_bytes_;
+}
+
+StatePersister::~StatePersister() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_one();
+  worker_.join();
+}
+
+void StatePersister::Update(RuntimeState &state) {
+  const Clock::time_point now = Clock::now();
+  TakeFailure(state, now);
+  if (state.revision != seen_revision_) {
+    if (seen_revision_ == submitted_revision_) {
+      first_change_ = now;
+    }
+    seen_revision_ = state.revision;
+    last_change_ = now;
+  }
+  if (retry_pending_) {
+    if (now >= retry_at_) {
+      Submit(state);
+    }
+    return;
+  }
+  if (seen_revision_ == submitted_revision_) {
+    return;
+  }
+  if (now - last_change_ >= debounce_ || now - first_change_ >= max_delay_) {
+    Submit(state);
+  }
+}
+
+bool StatePersister::Flush(RuntimeState &state) {
+  for (int attempt = 0;; ++attempt) {
+    TakeFailure(state, Clock::now());
+    seen_revision_ = state.revision;
+    if (retry_pending_ || seen_revision_ != submitted_revision_) {
+      Submit(state);
+    }
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      idle_.wait(lock, [this] { return !queued_snapshot_ && queued_records_.empty() && !busy_; });
+    }
+    if (!failed_.load()) {
+      return true;
+    }
+    if (attempt + 1 == kFlushAttempts) {
+      return false;
+    }
+    std::this_thread::sleep_for(RetryDelay());
+  }
+}
+
+std::optional<std::chrono::steady_clock::time_point> StatePersister::NextDeadline() const {
+  if (retry_pending_) {
+    return retry_at_;
+  }
+  if (seen_revision_ == submitted_revision_) {
+    return std::nullopt;
+  }
+  return std::min(last_change_ + debounce_, first_change_ + max_delay_);
+}
+
+StatePersister::Stats StatePersister::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+void StatePersister::TakeFailure(RuntimeState &state, Clock::time_point now) {
+  if (!failed_.exchange(false)) {
+    return;
+  }
+  // The failed records already left state.journal; a snapshot of the live
+  // state carries them instead.
+  state.snapshot_required = true;
+  retry_pending_ = true;
+  retry_at_ = now + RetryDelay();
+}
+
+StatePersister::Clock::duration StatePersister::RetryDelay() const {
+  const uint32_t failures = std::max<uint32_t>(consecutive_failures_.load(), 1);
+  const int64_t delay_ms = static_cast<int64_t>(kRetryMs) << std::min<uint32_t>(failures - 1, 5);
+  return std::chrono::milliseconds(std::min<int64_t>(delay_ms, kMaxRetryMs));
+}
+
+void StatePersister::Submit(RuntimeState &state) {
+  std::vector<StateMutation> records = std::move(state.journal);
+  state.journal.clear();
+  const bool snapshot = state.snapshot_required || compact_requested_.exchange(false);
+  state.snapshot_required = false;
+  std::optional<RuntimeState> copy;
+  if (snapshot) {
+    copy = state;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (copy) {
+      queued_snapshot_ = std::move(copy);
+      queued_records_.clear();
+    } else {
+      queued_records_.insert(queued_records_.end(), std::make_move_iterator(records.begin()),
+                             std::make_move_iterator(records.end()));
+    }
+  }
+  submitted_revision_ = state.revision;
+  retry_pending_ = false;
+  wake_.notify_one();
+}
+
+void StatePersister::Run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    wake_.wait(lock, [this] { return stopping_ || queued_snapshot_ || !queued_records_.empty(); });
+    if (!queued_snapshot_ && queued_records_.empty()) {
+      return;
+    }
+    std::optional<RuntimeState> snapshot = std::move(queued_snapshot_);
+    queued_snapshot_.reset();
+    std::vector<StateMutation> records = std::move(queued_records_);
+    queued_records_.clear();
+    busy_ = true;
+    lock.unlock();
+
+    const auto start = Clock::now();
+    bool ok = true;
+    bool wrote = false;
+    if (snapshot) {
+      wrote = true;
+      ok = WriteSnapshot(*snapshot);
+      snapshot_missing_ = !ok;
+    }
+    // Records queued after a failure are covered by the retry snapshot; the
+    // journal on disk belongs to a snapshot without the failed edits.
+    if (ok && !records.empty() && !snapshot_missing_) {
+      wrote = true;
+      ok = AppendRecords(records);
+      // A failed append may have left a partial record, so the journal is
+      // unusable until the retry snapshot starts a fresh one.
+      snapshot_missing_ = !ok;
+    }
+    if (ok && wrote) {
+      consecutive_failures_ = 0;
+    } else if (!ok) {
+      ++consecutive_failures_;
+    }
+    if (journal_bytes_ > kCompactBytes) {
+      compact_requested_ = true;
+    }
+    const double elapsed_ms =
+        std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    lock.lock();
+    if (!ok) {
+      ++stats_.failures;
+      failed_ = true;
+    } else {
+      stats_.last_save_ms = elapsed_ms;
+    }
+    stats_.journal_bytes = journal_bytes_;
+    busy_ = false;
+    if (!queued_snapshot_ && queued_records_.empty()) {
+      idle_.notify_all();
+    }
+  }
+}
+
+bool StatePersister::WriteSnapshot(const RuntimeState &state) {
+  writer_.Clear();
+  StateStore::Serialize(state, writer_);
+  const uint64_t hash = HashBytes(writer_.view());
+  if (last_hash_ && *last_hash_ == hash && journal_bytes_ == 0) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.unchanged;
+    return true;
+  }
+  if (!store_.WriteSnapshot(writer_.view())) {
+    last_hash_.reset();
+    return false;
+  }
+  last_hash_ = hash;
+  journal_bytes_ = 0;
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++stats_.snapshots;
+  return true;
+}
+
+bool StatePersister::AppendRecords(const std::vector<StateMutation> &records) {
+  records_.clear();
+  for (const StateMutation &mutation : records) {
+    writer_.Clear();
+    StateStore::SerializeMutation(mutation, writer_);
+    records_.append(writer_.view());
+    records_.push_back('\n');
+  }
+  if (!store_.AppendJournal(records_)) {
+    // Never skip the retry snapshot as unchanged: it has to replace the
+    // journal this append may have torn.
+    last_hash_.reset();
+    return false;
+  }
+  journal_bytes_ += records_.size();
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++stats_.appends;
+  stats_.records += records.size();
+  return true;
+}
+
+}  // namespace vita::data
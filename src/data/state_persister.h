@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "data/json.h"
+#include "data/state.h"
+
+namespace vita::data {
+
+// Saves RuntimeState off the render thread. Update() is called once per
+// frame and only compares revisions; once changes have been quiet for the
+// debounce interval (or have been pending for max_delay) the mutations
+// recorded since the last save are handed to a worker, which appends them to
+// the state journal. A full snapshot is written instead when the state was
+// edited outside the journal, and the worker asks for one (compaction) once
+// the journal grows past kCompactBytes. Snapshots whose bytes hash the same
+// as the last one written are skipped.
+//
+// A failed write never loses changes. The records it carried are not
+// retried; the next save is a full snapshot of the live state instead. Until
+// that snapshot succeeds the worker appends nothing to the old journal, whose
+// base would be missing the failed edits. Retries back off from kRetryMs to
+// kMaxRetryMs.
+class StatePersister {
+ public:
+  static constexpr int kDebounceMs = 750;
+  static constexpr int kMaxDelayMs = 5000;
+  static constexpr uintmax_t kCompactBytes = 64 * 1024;
+  static constexpr int kRetryMs = 250;
+  static constexpr int kMaxRetryMs = 8000;
+  static constexpr int kFlushAttempts = 4;
+
+  struct Stats {
+    uint64_t snapshots = 0;
+    uint64_t appends = 0;
+    uint64_t records = 0;
+    uint64_t unchanged = 0;
+    uint64_t failures = 0;
+    uintmax_t journal_bytes = 0;
+    double last_save_ms = 0.0;
+  };
+
+  StatePersister(StateStore store, const RuntimeState &state, int debounce_ms = kDebounceMs,
+                 int max_delay_ms = kMaxDelayMs);
+  ~StatePersister();
+
+  StatePersister(const StatePersister &) = delete;
+  StatePersister &operator=(const StatePersister &) = delete;
+
+  // Drains state.journal when a save is submitted.
+  void Update(RuntimeState &state);
+  // Queues pending changes and blocks until the worker is idle, retrying a
+  // failed save up to kFlushAttempts times. False when the state on disk is
+  // still behind.
+  bool Flush(RuntimeState &state);
+  Stats stats() const;
+  // When Update() will next submit pending changes, if any are pending.
+  std::optional<std::chrono::steady_clock::time_point> NextDeadline() const;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  // Picks up a failure reported by the worker: forces the next save to be a
+  // snapshot and schedules it after the current backoff.
+  void TakeFailure(RuntimeState &state, Clock::time_point now);
+  Clock::duration RetryDelay() const;
+  void Submit(RuntimeState &state);
+  void Run();
+  bool WriteSnapshot(const RuntimeState &state);
+  bool AppendRecords(const std::vector<StateMutation> &records);
+
+  StateStore store_;
+  std::chrono::milliseconds debounce_;
+  std::chrono::milliseconds max_delay_;
+
+  // Render-thread bookkeeping.
+  uint64_t seen_revision_ = 0;
+  uint64_t submitted_revision_ = 0;
+  Clock::time_point first_change_;
+  Clock::time_point last_change_;
+  std::atomic<bool> compact_requested_{false};
+  bool retry_pending_ = false;
+  Clock::time_point retry_at_;
+  // Set by the worker after a failed write; consecutive_failures_ drives the
+  // backoff and is reset by the next successful save.
+  std::atomic<bool> failed_{false};
+  std::atomic<uint32_t> consecutive_failures_{0};
+
+  mutable std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable idle_;
+  // A queued snapshot supersedes everything before it; queued records are
+  // always newer than the queued snapshot.
+  std::optional<RuntimeState> queued_snapshot_;
+  std::vector<StateMutation> queued_records_;
+  bool busy_ = false;
+  bool stopping_ = false;
+  Stats stats_;
+
+  // Worker-only.
+  JsonWriter writer_;
+  std::string records_;
+  std::optional<uint64_t> last_hash_;
+  bool snapshot_missing_ = false;
+  uintmax_t journal_bytes_ = 0;
+
+  std::thread worker_;
+};
+
+}  // namespace vita::data
@@ -1,25 +1,44 @@
 #include <SDL.h>
 
+#include <algorithm>
 #include <chrono>
+#include <cstdlib>
 #include <filesystem>
 #include <iostream>
 #include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include "data/library.h"
+#include "data/library_reloader.h"
+#include "data/process_supervisor.h"
 #include "data/state.h"
+#include "data/state_persister.h"
 #include "scenes/home_screen.h"
 #include "scenes/index_screen.h"
 #include "scenes/notifications_screen.h"
 #include "scenes/overlays.h"
+#include "scenes/profiler_hud.h"
 #include "scenes/scene_stack.h"
+#include "ui/background_residency.h"
 #include "ui/constants.h"
+#include "ui/frame_scheduler.h"
+#include "ui/headless.h"
+#include "ui/image_pipeline.h"
 #include "ui/layout.h"
+#include "ui/profiler.h"
 #include "ui/renderer.h"
+#include "ui/thumbnail_cache.h"
 
 namespace {
 
-std::vector<std::vector<std::string>> BuildDefaultPages(const vita::data::Library &library) {
-  std::vector<std::vector<std::string>> pages{std::vector<std::string>{}};
+constexpr auto kHomeHoldTime = std::chrono::milliseconds(600);
+constexpr const char *kTracePath = "profile_trace.json";
+constexpr int kHeadlessFrameMs = 16;
+
+std::vector<std::vector<vita::data::ItemId>> BuildDefaultPages(const vita::data::Library &library) {
+  std::vector<std::vector<vita::data::ItemId>> pages{std::vector<vita::data::ItemId>{}};
   for (const auto &item : library.items()) {
     if (pages.back().size() >= 15) {
       pages.emplace_back();
@@ -29,11 +48,162 @@ std::vector<std::vector<std::string>> BuildDefaultPages(const vita::data::Librar
   return pages;
 }
 
+// Renders `frames` full repaints of the default scene stack with the SDL
+// software renderer, prints frame timings and optionally writes the last
+// frame to `dump_path`. Every frame is damaged in full so the numbers
+// measure drawing rather than damage tracking skipping it.
+int RunHeadless(const vita::data::Library &library, vita::data::RuntimeState &state, int frames,
+                const std::filesystem::path &dump_path) {
+  if (SDL_Init(0) != 0) {
+    std::cerr << "SDL init failed: " << SDL_GetError() << "\n";
+    return 1;
+  }
+  int exit_code = 0;
+  try {
+    vita::ui::HeadlessTarget target;
+    vita::ui::Renderer render(target.renderer());
+    vita::ui::Profiler profiler;
+
+    vita::scenes::HomeScreen home(library, state);
+    vita::scenes::NotificationsScreen notifications(state);
+    vita::scenes::IndexScreen index_screen(library, state);
+    vita::scenes::QuickMenuOverlay quick_menu;
+
+    vita::scenes::SceneStack stack;
+    stack.SetProfiler(&profiler);
+    stack.Push(&home);
+    stack.Push(&notifications);
+    stack.Push(&index_screen);
+    stack.Push(&quick_menu);
+
+    std::vector<double> frame_ms;
+    frame_ms.reserve(static_cast<size_t>(frames));
+    int draw_calls = 0;
+    for (int frame = 0; frame < frames; ++frame) {
+      const auto start = std::chrono::steady_clock::now();
+      stack.Update(kHeadlessFrameMs);
+      stack.DamageAll();
+      render.BeginFrame();
+      stack.Render(render);
+      render.EndFrame();
+      SDL_RenderPresent(target.renderer());
+      frame_ms.push_back(std::chrono::duration<double, std::milli>(
+                             std::chrono::steady_clock::now() - start)
+                             .count());
+      draw_calls += render.stats().draw_calls;
+    }
+
+    std::vector<double> sorted = frame_ms;
+    std::sort(sorted.begin(), sorted.end());
+    double total = 0.0;
+    for (const double ms : sorted) {
+      total += ms;
+    }
+    std::cout << "Rendered " << frames << " headless frames: mean " << total / frames
+              << " ms, p50 " << sorted[(sorted.size() - 1) / 2] << " ms, p99 "
+              << sorted[(sorted.size() - 1) * 99 / 100] << " ms, max " << sorted.back()
+              << " ms, " << static_cast<double>(draw_calls) / frames
+              << " draw calls per frame\n";
+    profiler.Collect();
+    for (const auto &summary : profiler.Summaries()) {
+      std::cout << "  " << summary.name << " " << summary.category << ": p50 " << summary.p50_ms
+                << " ms, p99 " << summary.p99_ms << " ms\n";
+    }
+    if (!dump_path.empty()) {
+      if (target.Save(dump_path)) {
+        std::cout << "Wrote last frame to " << dump_path.string() << "\n";
+      } else {
+        std::cerr << "Failed to write " << dump_path.string() << ": " << SDL_GetError() << "\n";
+        exit_code = 1;
+      }
+    }
+  } catch (const std::exception &error) {
+    std::cerr << error.what() << "\n";
+    exit_code = 1;
+  }
+  SDL_Quit();
+  return exit_code;
+}
+
 }  // namespace
 
 int main(int argc, char **argv) {
-  (void)argc;
-  (void)argv;
+  if (argc >= 2 && std::string(argv[1]) == "--compile-library") {
+    const std::filesystem::path library_path =
+        (argc >= 3) ? argv[2]
+        : std::filesystem::is_directory("data/library.d") ? "data/library.d"
+                                                          : "data/library.json";
+    if (!vita::data::Library::CompileSnapshot(library_path)) {
+      std::cerr << "Failed to compile library snapshot for " << library_path << "\n";
+      return 1;
+    }
+    return 0;
+  }
+
+  // --fps=vsync (default), --fps=<cap> or --fps=unlimited.
+  // --headless=<frames> renders without a window; --dump=<file.ppm|.bmp>
+  // keeps its last frame. --background-budget-mb=<n> caps resident page
+  // backgrounds.
+  std::optional<vita::ui::FrameScheduler> scheduler =
+      vita::ui::FrameScheduler::FromString("vsync");
+  int headless_frames = 0;
+  std::filesystem::path dump_path;
+  uintmax_t background_budget = vita::ui::BackgroundResidency::kDefaultBudgetBytes;
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view arg = argv[i];
+    if (arg.substr(0, 11) == "--headless=") {
+      const std::string count(arg.substr(11));
+      char *end = nullptr;
+      const long frames = std::strtol(count.c_str(), &end, 10);
+      if (count.empty() || *end != '\0' || frames <= 0 || frames > 1000000) {
+        std::cerr << "Invalid frame count '" << count << "' for --headless\n";
+        return 1;
+      }
+      headless_frames = static_cast<int>(frames);
+    } else if (arg.substr(0, 7) == "--dump=") {
+      dump_path = std::string(arg.substr(7));
+    } else if (arg.substr(0, 23) == "--background-budget-mb=") {
+      const std::string megabytes(arg.substr(23));
+      char *end = nullptr;
+      const long value = std::strtol(megabytes.c_str(), &end, 10);
+      if (megabytes.empty() || *end != '\0' || value < 0 || value > 4096) {
+        std::cerr << "Invalid background budget '" << megabytes << "' MiB\n";
+        return 1;
+      }
+      background_budget = static_cast<uintmax_t>(value) * 1024 * 1024;
+    } else if (arg.substr(0, 6) == "--fps=") {
+      scheduler = vita::ui::FrameScheduler::FromString(arg.substr(6));
+      if (!scheduler) {
+        std::cerr << "Invalid frame pacing '" << arg.substr(6)
+                  << "'; use vsync, unlimited or a frame rate\n";
+        return 1;
+      }
+    }
+  }
+
+  const std::filesystem::path library_path =
+      std::filesystem::is_directory("data/library.d") ? "data/library.d" : "data/library.json";
+  vita::data::Library library = vita::data::Library::Load(library_path);
+  for (const auto &shard : library.shard_stats()) {
+    std::cout << "Loaded " << shard.item_count << " items from " << shard.path.filename().string()
+              << " in " << shard.load_ms << " ms\n";
+  }
+  vita::data::StateStore state_store(std::filesystem::path("data/state.json"));
+  vita::data::RuntimeState state = state_store.Load();
+  vita::data::StatePersister persister(state_store, state);
+  if (state.pages.empty()) {
+    state.pages = BuildDefaultPages(library);
+    state.MarkDirty();
+  }
+  try {
+    state.EnsureLimits(library.items().size());
+  } catch (const std::exception &error) {
+    std::cerr << "State invalid: " << error.what() << "\n";
+  }
+
+  if (headless_frames > 0) {
+    return RunHeadless(library, state, headless_frames, dump_path);
+  }
 
   if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_GAMECONTROLLER) != 0) {
     std::cerr << "SDL init failed: " << SDL_GetError() << "\n";
@@ -49,7 +219,7 @@ int main(int argc, char **argv) {
     return 1;
   }
 
-  SDL_Renderer *renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+  SDL_Renderer *renderer = SDL_CreateRenderer(window, -1, scheduler->renderer_flags());
   if (!renderer) {
     std::cerr << "Failed to create renderer: " << SDL_GetError() << "\n";
     SDL_DestroyWindow(window);
@@ -61,135 +231,281 @@ int main(int argc, char **argv) {
                                              SDL_TEXTUREACCESS_TARGET,
                                              vita::ui::kBaseWidth, vita::ui::kBaseHeight);
 
-  vita::data::Library library = vita::data::Library::Load("data/library.json");
-  vita::data::StateStore state_store(std::filesystem::path("data/state.json"));
-  vita::data::RuntimeState state = state_store.Load();
-  if (state.pages.empty()) {
-    state.pages = BuildDefaultPages(library);
-  }
-  try {
-    state.EnsureLimits(library.items().size());
-  } catch (const std::exception &error) {
-    std::cerr << "State invalid: " << error.what() << "\n";
-  }
+  // Everything holding textures, threads or SDL callbacks lives in this block so
+  // it is torn down before the renderer and SDL itself.
+  {
+    // Declared first so the shape atlas texture goes last, but still before
+    // SDL_DestroyRenderer; the same order RunHeadless gets from HeadlessTarget.
+    vita::ui::Renderer render(renderer);
+
+    vita::data::LibraryReloader library_reloader(library_path, library, [] {
+      SDL_Event wake{};
+      wake.type = SDL_USEREVENT;
+      SDL_PushEvent(&wake);
+    });
+
+    vita::data::ProcessSupervisor processes([] {
+      SDL_Event wake{};
+      wake.type = SDL_USEREVENT;
+      SDL_PushEvent(&wake);
+    });
+
+    vita::scenes::HomeScreen home(library, state);
+    vita::scenes::NotificationsScreen notifications(state);
+    vita::scenes::IndexScreen index_screen(library, state);
+    vita::scenes::QuickMenuOverlay quick_menu;
+    vita::ui::Profiler profiler;
+    vita::scenes::ProfilerHud profiler_hud(profiler);
+    vita::ui::ThumbnailCache thumbnails(std::filesystem::path("data/thumbnails"));
+    vita::ui::ImagePipeline images(
+        renderer, 0,
+        [] {
+          SDL_Event wake{};
+          wake.type = SDL_USEREVENT;
+          SDL_PushEvent(&wake);
+        },
+        &profiler, &thumbnails);
+    vita::ui::BackgroundResidency backgrounds(images, background_budget);
+    home.SetImages(&images, &backgrounds);
+
+    vita::scenes::SceneStack stack;
+    stack.SetProfiler(&profiler);
+    stack.Push(&home);
+    stack.Push(&notifications);
+    stack.Push(&index_screen);
+    stack.Push(&quick_menu);
+    stack.Push(&profiler_hud);
+
+    vita::ui::VirtualCanvas canvas;
+
+    bool running = true;
+    std::optional<std::chrono::steady_clock::time_point> home_down;
+    std::optional<std::chrono::steady_clock::time_point> touch_down;
+
+    auto last_time = std::chrono::steady_clock::now();
 
-  vita::scenes::HomeScreen home(library, state);
-  vita::scenes::NotificationsScreen notifications(state);
-  vita::scenes::IndexScreen index_screen(state);
-  vita::scenes::QuickMenuOverlay quick_menu;
-
-  vita::scenes::SceneStack stack;
-  stack.Push(&home);
-  stack.Push(&notifications);
-  stack.Push(&index_screen);
-  stack.Push(&quick_menu);
-
-  vita::ui::Renderer render(renderer);
-  vita::ui::VirtualCanvas canvas;
-
-  bool running = true;
-  std::optional<std::chrono::steady_clock::time_point> home_down;
-  std::optional<std::chrono::steady_clock::time_point> touch_down;
-
-  auto last_time = std::chrono::steady_clock::now();
-
-  while (running) {
-    SDL_Event event;
-    while (SDL_PollEvent(&event)) {
-      if (event.type == SDL_QUIT) {
-        running = false;
-        break;
-      }
-      if (event.type == SDL_KEYDOWN) {
-        switch (event.key.keysym.sym) {
-          case SDLK_ESCAPE:
-            stack.HandleEvent({vita::scenes::InputEvent::Type::kKey, "back"});
-            break;
-          case SDLK_RETURN:
-            stack.HandleEvent({vita::scenes::InputEvent::Type::kKey, "accept"});
-            break;
-          case SDLK_LEFT:
-            stack.HandleEvent({vita::scenes::InputEvent::Type::kKey, "left"});
-            break;
-          case SDLK_RIGHT:
-            stack.HandleEvent({vita::scenes::InputEvent::Type::kKey, "right"});
-            break;
-          case SDLK_UP:
-            stack.HandleEvent({vita::scenes::InputEvent::Type::kKey, "up"});
-            break;
-          case SDLK_DOWN:
-            stack.HandleEvent({vita::scenes::InputEvent::Type::kKey, "down"});
-            break;
-          case SDLK_SPACE:
-            if (!home_down) {
-              home_down = std::chrono::steady_clock::now();
+    bool drawing = true;
+    bool present_pending = true;
+
+    while (running) {
+      // Everything that must happen without input bounds how long we may sleep.
+      if (const std::optional<int> deadline = stack.NextDeadlineMs()) {
+        scheduler->WakeIn(*deadline);
+      }
+      if (home_down && !quick_menu.visible()) {
+        scheduler->WakeAt(*home_down + kHomeHoldTime);
+      }
+      if (const auto save_due = persister.NextDeadline()) {
+        scheduler->WakeAt(*save_due);
+      }
+      if (images.has_pending_uploads()) {
+        scheduler->WakeIn(0);
+      }
+
+      SDL_Event event;
+      bool have_event = scheduler->WaitForEvent(event, drawing);
+      for (; have_event; have_event = SDL_PollEvent(&event) == 1) {
+        if (event.type == SDL_QUIT) {
+          running = false;
+          break;
+        }
+        if (event.type == SDL_WINDOWEVENT) {
+          present_pending = true;
+        }
+        if (event.type == SDL_RENDER_TARGETS_RESET) {
+          stack.DamageAll();
+          present_pending = true;
+        }
+        if (event.type == SDL_RENDER_DEVICE_RESET) {
+          // Every texture was lost with the device; recreate them from scratch.
+          render.HandleDeviceReset();
+          images.HandleDeviceReset();
+          SDL_DestroyTexture(offscreen);
+          offscreen = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888,
+                                        SDL_TEXTUREACCESS_TARGET, vita::ui::kBaseWidth,
+                                        vita::ui::kBaseHeight);
+          stack.DamageAll();
+          present_pending = true;
+        }
+        if (event.type == SDL_KEYDOWN) {
+          switch (event.key.keysym.sym) {
+            case SDLK_ESCAPE:
+              stack.HandleEvent({vita::scenes::InputEvent::Type::kKey, "back"});
+              break;
+            case SDLK_RETURN:
+              stack.HandleEvent({vita::scenes::InputEvent::Type::kKey, "accept"});
+              break;
+            case SDLK_LEFT:
+              stack.HandleEvent({vita::scenes::InputEvent::Type::kKey, "left"});
+              break;
+            case SDLK_RIGHT:
+              stack.HandleEvent({vita::scenes::InputEvent::Type::kKey, "right"});
+              break;
+            case SDLK_UP:
+              stack.HandleEvent({vita::scenes::InputEvent::Type::kKey, "up"});
+              break;
+            case SDLK_DOWN:
+              stack.HandleEvent({vita::scenes::InputEvent::Type::kKey, "down"});
+              break;
+            case SDLK_SPACE:
+              if (!home_down) {
+                home_down = std::chrono::steady_clock::now();
+              }
+              break;
+            case SDLK_TAB:
+              notifications.Toggle();
+              break;
+            case SDLK_F3:
+              profiler_hud.Toggle();
+              break;
+            case SDLK_F4:
+              if (profiler.ExportChromeTrace(kTracePath)) {
+                std::cout << "Wrote frame trace to " << kTracePath << "\n";
+              } else {
+                std::cerr << "Failed to write frame trace to " << kTracePath << "\n";
+              }
+              break;
+            case SDLK_n:
+              state.PushNotification({"New trophy unlocked", vita::data::ItemId()});
+              home.ShowNotificationToast("New notification", vita::ui::kNotificationToastMs);
+              break;
+            default:
+              break;
+          }
+        }
+        if (event.type == SDL_KEYUP && event.key.keysym.sym == SDLK_SPACE) {
+          if (home_down) {
+            auto elapsed =
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - *home_down);
+            if (elapsed < kHomeHoldTime && !quick_menu.visible()) {
+              index_screen.Toggle();
             }
-            break;
-          case SDLK_TAB:
-            notifications.Toggle();
-            break;
-          case SDLK_n:
-            state.notifications.push_back({"New trophy unlocked", ""});
-            home.ShowNotificationToast("New notification", vita::ui::kNotificationToastMs);
-            break;
-          default:
-            break;
+            home_down.reset();
+          }
         }
-      }
-      if (event.type == SDL_KEYUP && event.key.keysym.sym == SDLK_SPACE) {
-        if (home_down) {
-          auto elapsed =
-              std::chrono::duration<double>(std::chrono::steady_clock::now() - *home_down);
-          if (elapsed.count() <= 0.6 && !quick_menu.visible()) {
-            index_screen.Toggle();
+        if (event.type == SDL_MOUSEBUTTONDOWN) {
+          touch_down = std::chrono::steady_clock::now();
+        }
+        if (event.type == SDL_MOUSEBUTTONUP) {
+          if (touch_down) {
+            const auto elapsed =
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - *touch_down);
+            if (elapsed.count() > 0.45) {
+              stack.HandleEvent({vita::scenes::InputEvent::Type::kTouchHold, nullptr});
+            }
+            touch_down.reset();
           }
-          home_down.reset();
         }
       }
-      if (event.type == SDL_MOUSEBUTTONDOWN) {
-        touch_down = std::chrono::steady_clock::now();
+
+      if (home_down) {
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - *home_down);
+        if (elapsed >= kHomeHoldTime) {
+          quick_menu.SetVisible(true);
+          home_down.reset();
+        }
       }
-      if (event.type == SDL_MOUSEBUTTONUP) {
-        if (touch_down) {
-          const auto elapsed =
-              std::chrono::duration<double>(std::chrono::steady_clock::now() - *touch_down);
-          if (elapsed.count() > 0.45) {
-            stack.HandleEvent({vita::scenes::InputEvent::Type::kTouchHold, nullptr});
-          }
-          touch_down.reset();
+
+      auto now = std::chrono::steady_clock::now();
+      const int dt_ms =
+          static_cast<int>(std::chrono::duration<double, std::milli>(now - last_time).count());
+      last_time = now;
+
+      if (const auto reload = library_reloader.Apply(library, state)) {
+        if (reload->error.empty()) {
+          stack.DamageAll();
+          std::cout << "Library reloaded: +" << reload->added << " -" << reload->removed << " ~"
+                    << reload->changed << " (load " << reload->load_ms << " ms, apply "
+                    << reload->apply_ms << " ms)\n";
+        } else {
+          std::cerr << "Library reload failed: " << reload->error << "\n";
         }
       }
-    }
 
-    if (home_down) {
-      auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - *home_down);
-      if (elapsed.count() > 0.6) {
-        quick_menu.SetVisible(true);
-        home_down.reset();
+      for (const auto &exited : processes.Reap()) {
+        const vita::data::LibraryItem *item = library.Find(exited.item);
+        const std::string title = item ? item->title : "Title";
+        std::string message;
+        if (exited.signal != 0) {
+          message = title + " was stopped by signal " + std::to_string(exited.signal);
+        } else if (exited.exit_code != 0) {
+          message = title + " exited with status " + std::to_string(exited.exit_code);
+        } else {
+          message = title + " closed";
+        }
+        std::cout << message << " after " << exited.runtime_s << " s\n";
+        state.PushNotification({message, exited.item});
+        home.ShowNotificationToast(message, vita::ui::kNotificationToastMs);
       }
-    }
 
-    auto now = std::chrono::steady_clock::now();
-    const int dt_ms =
-        static_cast<int>(std::chrono::duration<double, std::milli>(now - last_time).count());
-    last_time = now;
+      backgrounds.Update(state);
+      images.Upload();
+      stack.Update(dt_ms);
+      persister.Update(state);
 
-    stack.Update(dt_ms);
+      SDL_SetRenderTarget(renderer, offscreen);
+      render.BeginFrame();
+      const bool drew = stack.Render(render);
+      {
+        vita::ui::ProfileScope scope(&profiler, "frame", "submit");
+        render.EndFrame();
+      }
+      SDL_SetRenderTarget(renderer, nullptr);
+      drawing = drew;
+      if (!drew && !present_pending) {
+        continue;
+      }
+      present_pending = false;
 
-    SDL_SetRenderTarget(renderer, offscreen);
-    stack.Render(render);
-    SDL_SetRenderTarget(renderer, nullptr);
+      int win_w = 0;
+      int win_h = 0;
+      SDL_GetWindowSize(window, &win_w, &win_h);
+      vita::ui::Letterbox letterbox = canvas.ComputeLetterbox(win_w, win_h);
+      SDL_Rect dst{letterbox.x, letterbox.y, letterbox.width, letterbox.height};
+      {
+        vita::ui::ProfileScope scope(&profiler, "frame", "blit");
+        SDL_RenderCopy(renderer, offscreen, nullptr, &dst);
+      }
+      {
+        vita::ui::ProfileScope scope(&profiler, "frame", "present");
+        SDL_RenderPresent(renderer);
+      }
+      scheduler->FramePresented();
+    }
 
-    int win_w = 0;
-    int win_h = 0;
-    SDL_GetWindowSize(window, &win_w, &win_h);
-    vita::ui::Letterbox letterbox = canvas.ComputeLetterbox(win_w, win_h);
-    SDL_Rect dst{letterbox.x, letterbox.y, letterbox.width, letterbox.height};
-    SDL_RenderCopy(renderer, offscreen, nullptr, &dst);
-    SDL_RenderPresent(renderer);
+    if (!persister.Flush(state)) {
+      std::cerr << "Failed to save state; the last changes were not written\n";
+    }
+    const vita::ui::FrameScheduler::Stats &frames = scheduler->stats();
+    std::cout << "Presented " << frames.frames << " frames (" << frames.fps << " fps, "
+              << static_cast<int>(frames.sleep_ratio * 100.0) << "% asleep over the last second, "
+              << frames.slept_ms / 1000.0 << " s asleep in total)\n";
+    const vita::ui::ImagePipeline::Stats &image_stats = images.stats();
+    if (image_stats.uploaded > 0) {
+      std::cout << "Images: " << image_stats.uploaded << " of " << image_stats.requested
+                << " loaded, " << image_stats.failed << " failed; decode avg "
+                << image_stats.decode_ms_total / (image_stats.uploaded + image_stats.failed)
+                << " ms (max "
+                << image_stats.decode_ms_max << "), upload avg "
+                << image_stats.upload_ms_total / image_stats.uploaded << " ms (max "
+                << image_stats.upload_ms_max << "), request to ready avg "
+                << image_stats.ready_ms_total / image_stats.uploaded << " ms (max "
+                << image_stats.ready_ms_max << ")\n";
+    }
+    const vita::ui::BackgroundResidency::Stats &background_stats = backgrounds.stats();
+    std::cout << "Backgrounds: " << background_stats.hits << " flips ready, "
+              << background_stats.misses << " waited, " << background_stats.prefetches
+              << " prefetched, " << background_stats.evictions << " evicted, "
+              << background_stats.resident << " resident ("
+              << background_stats.resident_bytes / 1024 << " KiB)\n";
+    const vita::ui::ThumbnailCache::Stats thumbnail_stats = thumbnails.stats();
+    std::cout << "Thumbnail cache: " << thumbnail_stats.hits << " hits, " << thumbnail_stats.misses
+              << " misses, " << thumbnail_stats.stores << " stored, " << thumbnail_stats.evictions
+              << " evicted, " << thumbnail_stats.entries << " files ("
+              << thumbnail_stats.bytes / 1024 << " KiB)\n";
+    std::cout << "Shape atlas: " << render.atlas().entry_count() << " shapes, "
+              << render.atlas().memory_bytes() / 1024 << " KiB\n";
   }
-
-  state_store.Save(state);
   SDL_DestroyTexture(offscreen);
   SDL_DestroyRenderer(renderer);
   SDL_DestroyWindow(window);
@@ -7,21 +7,61 @@
 
 namespace vita::scenes {
 
+namespace {
+
+constexpr SDL_Rect kToastRect{ui::kBaseWidth - 280, ui::kInfoBarHeight + 12, 260, 40};
+constexpr int kFocusMargin = 3;
+
+SDL_Rect IconRect(int slot) {
+  const int column = slot % ui::kGridColumns;
+  const int row = slot / ui::kGridColumns;
+  return {ui::kGridLeft + column * (ui::kIconSize + ui::kIconPaddingX),
+          ui::kGridTop + row * (ui::kIconSize + ui::kIconPaddingY), ui::kIconSize, ui::kIconSize};
+}
+
+SDL_Rect FocusRect(int slot) {
+  const SDL_Rect icon = IconRect(slot);
+  return {icon.x - kFocusMargin, icon.y - kFocusMargin, icon.w + kFocusMargin * 2,
+          icon.h + kFocusMargin * 2};
+}
+
+}  // namespace
+
 HomeScreen::HomeScreen(const data::Library &library, data::RuntimeState &state)
-    : library_(library), state_(state) {}
+    : library_(library),
+      state_(state),
+      seen_revision_(state.revision),
+      seen_page_(state.current_page) {}
+
+void HomeScreen::SetFocus(int index) {
+  if (index == focused_index_) {
+    return;
+  }
+  AddDamage(FocusRect(focused_index_));
+  AddDamage(FocusRect(index));
+  focused_index_ = index;
+}
 
 void HomeScreen::HandleEvent(const InputEvent &event) {
-  if (event.type == InputEvent::Type::kTouchHold) {
+  if (event.type == InputEvent::Type::kTouchHold && !edit_mode_) {
     edit_mode_ = true;
+    DamageAll();
   }
   if (event.type == InputEvent::Type::kKey && event.key) {
     std::string key(event.key);
     if (key == "left") {
-      focused_index_ = std::max(0, focused_index_ - 1);
+      SetFocus(std::max(0, focused_index_ - 1));
     } else if (key == "right") {
-      focused_index_ += 1;
-    } else if (key == "back") {
+      SetFocus(focused_index_ + 1);
+    } else if ((key == "up" && state_.current_page > 0) ||
+               (key == "down" &&
+                static_cast<size_t>(state_.current_page) + 1 < state_.pages.size())) {
+      // Update() notices the page change and repaints everything.
+      state_.SetCurrentPage(state_.current_page + (key == "down" ? 1 : -1));
+      focused_index_ = 0;
+    } else if (key == "back" && edit_mode_) {
       edit_mode_ = false;
+      DamageAll();
     }
   }
 }
@@ -31,20 +71,89 @@ void HomeScreen::Update(int dt_ms) {
     toast_timer_ms_ = std::max(0, toast_timer_ms_ - dt_ms);
     if (toast_timer_ms_ == 0) {
       toast_message_.clear();
+      AddDamage(kToastRect);
+    }
+  }
+  // Layout edits and page flips can come from anywhere (input, hot reload,
+  // journal replay); any of them repaints the page.
+  if (state_.revision != seen_revision_ || state_.current_page != seen_page_) {
+    seen_revision_ = state_.revision;
+    seen_page_ = state_.current_page;
+    DamageAll();
+  }
+  if (images_ && !placeholders_.empty() && images_->generation() != seen_image_generation_) {
+    seen_image_generation_ = images_->generation();
+    for (const SDL_Rect &rect : placeholders_) {
+      AddDamage(rect);
     }
   }
 }
 
+std::optional<int> HomeScreen::NextDeadlineMs() const {
+  if (toast_timer_ms_ > 0) {
+    return toast_timer_ms_;
+  }
+  return std::nullopt;
+}
+
 void HomeScreen::Render(ui::Renderer &renderer) {
+  placeholders_.clear();
   renderer.Clear(ui::kColorBackground);
+  RenderBackground(renderer);
   renderer.DrawRect(0, 0, ui::kBaseWidth, ui::kInfoBarHeight, ui::kColorPanel);
+  RenderIcons(renderer);
   RenderPageDots(renderer);
   if (!toast_message_.empty()) {
-    renderer.DrawRect(ui::kBaseWidth - 280, ui::kInfoBarHeight + 12, 260, 40, ui::kColorPanel);
+    renderer.DrawPanel(kToastRect.x, kToastRect.y, kToastRect.w, kToastRect.h, ui::kColorPanel,
+                       ui::kPanelRadius);
   }
   if (edit_mode_) {
-    renderer.DrawRectOutline(12, ui::kInfoBarHeight + 8, ui::kBaseWidth - 24, ui::kBaseHeight - 80,
-                             ui::kColorFocus, 2);
+    renderer.DrawPanelOutline(12, ui::kInfoBarHeight + 8, ui::kBaseWidth - 24,
+                              ui::kBaseHeight - 80, ui::kColorFocus, 2, ui::kPanelRadius);
+  }
+}
+
+void HomeScreen::RenderBackground(ui::Renderer &renderer) {
+  if (!backgrounds_ || state_.page_backgrounds.count(state_.current_page) == 0) {
+    return;
+  }
+  const SDL_Rect canvas{0, 0, ui::kBaseWidth, ui::kBaseHeight};
+  if (SDL_Texture *texture = backgrounds_->Get(state_, state_.current_page)) {
+    renderer.DrawTexture(texture, canvas);
+  } else {
+    placeholders_.push_back(canvas);
+  }
+}
+
+void HomeScreen::RenderIcons(ui::Renderer &renderer) {
+  if (state_.current_page < 0 || static_cast<size_t>(state_.current_page) >= state_.pages.size()) {
+    return;
+  }
+  const auto &page = state_.pages[static_cast<size_t>(state_.current_page)];
+  const size_t slots = std::min(page.size(), static_cast<size_t>(ui::kGridColumns * ui::kGridRows));
+  for (size_t slot = 0; slot < slots; ++slot) {
+    const data::ItemId id = page[slot];
+    const data::LibraryItem *item = id.is_folder() ? nullptr : library_.Find(id);
+    if (!id.is_folder() && !item) {
+      continue;
+    }
+    const SDL_Rect icon = IconRect(static_cast<int>(slot));
+    SDL_Texture *texture = (images_ && item)
+                               ? images_->Get(item->icon_path, ui::kIconSize, ui::kIconSize)
+                               : nullptr;
+    if (texture) {
+      renderer.DrawTexture(texture, icon);
+    } else {
+      renderer.DrawPanel(icon.x, icon.y, icon.w, icon.h, ui::kColorPanel, ui::kIconRadius);
+      if (item && !item->icon_path.empty()) {
+        placeholders_.push_back(icon);
+      }
+    }
+    if (static_cast<int>(slot) == focused_index_) {
+      const SDL_Rect focus = FocusRect(static_cast<int>(slot));
+      renderer.DrawPanelOutline(focus.x, focus.y, focus.w, focus.h, ui::kColorFocus, 2,
+                                ui::kIconRadius + kFocusMargin);
+    }
   }
 }
 
@@ -65,6 +174,7 @@ void HomeScreen::RenderPageDots(ui::Renderer &renderer) {
 void HomeScreen::ShowNotificationToast(std::string message, int duration_ms) {
   toast_message_ = std::move(message);
   toast_timer_ms_ = duration_ms;
+  AddDamage(kToastRect);
 }
 
 }  // namespace vita::scenes
@@ -1,10 +1,15 @@
 #pragma once
 
+#include <cstdint>
+#include <optional>
 #include <string>
+#include <vector>
 
 #include "data/library.h"
 #include "data/state.h"
 #include "scenes/scene.h"
+#include "ui/background_residency.h"
+#include "ui/image_pipeline.h"
 
 namespace vita::scenes {
 
@@ -12,11 +17,19 @@ class HomeScreen : public Scene {
  public:
   HomeScreen(const data::Library &library, data::RuntimeState &state);
 
+  const char *name() const override { return "home"; }
   void HandleEvent(const InputEvent &event) override;
   void Update(int dt_ms) override;
   void Render(ui::Renderer &renderer) override;
+  std::optional<int> NextDeadlineMs() const override;
 
   void ShowNotificationToast(std::string message, int duration_ms);
+  // Draws item icons from `images` and page backgrounds from `backgrounds`
+  // once loaded; null keeps placeholders.
+  void SetImages(ui::ImagePipeline *images, ui::BackgroundResidency *backgrounds = nullptr) {
+    images_ = images;
+    backgrounds_ = backgrounds;
+  }
 
  private:
   const data::Library &library_;
@@ -25,7 +38,17 @@ class HomeScreen : public Scene {
   bool edit_mode_ = false;
   int toast_timer_ms_ = 0;
   std::string toast_message_;
-
+  uint64_t seen_revision_ = 0;
+  int seen_page_ = 0;
+  ui::ImagePipeline *images_ = nullptr;
+  ui::BackgroundResidency *backgrounds_ = nullptr;
+  uint64_t seen_image_generation_ = 0;
+  // Artwork last drawn as placeholders, repainted when new textures land.
+  std::vector<SDL_Rect> placeholders_;
+
+  void SetFocus(int index);
+  void RenderBackground(ui::Renderer &renderer);
+  void RenderIcons(ui::Renderer &renderer);
   void RenderPageDots(ui::Renderer &renderer);
 };
 
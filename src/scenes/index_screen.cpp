@@ -1,29 +1,88 @@
 #include "scenes/index_screen.h"
 
+#include <algorithm>
 #include <string>
 
 #include "ui/constants.h"
 
 namespace vita::scenes {
 
-IndexScreen::IndexScreen(data::RuntimeState &state) : state_(state) {}
+namespace {
+
+constexpr size_t kIndexRows = 8;
+constexpr int kIndexRowHeight = 30;
+constexpr int kIndexRowSpacing = 6;
+constexpr SDL_Rect kIndexPanel{140, 120, ui::kBaseWidth - 280, ui::kBaseHeight - 240};
+
+// A one-character title bound for the group of titles sharing `item`'s first
+// letter (offset 0) or for the group after it (offset 1). The letter is
+// lower-cased first, matching the library's ASCII case-folded title order, so
+// the bound after 'Z' is '{' rather than '['.
+std::string LetterBound(const data::LibraryItem &item, int offset) {
+  int letter = item.title.empty() ? 0 : static_cast<unsigned char>(item.title[0]);
+  if (letter >= 'A' && letter <= 'Z') {
+    letter += 'a' - 'A';
+  }
+  return std::string(1, static_cast<char>(std::min(255, letter + offset)));
+}
+
+}  // namespace
+
+IndexScreen::IndexScreen(const data::Library &library, data::RuntimeState &state)
+    : library_(library), state_(state) {}
 
 void IndexScreen::HandleEvent(const InputEvent &event) {
   if (!visible_) {
     return;
   }
-  if (event.type == InputEvent::Type::kKey && event.key && std::string(event.key) == "back") {
+  if (event.type != InputEvent::Type::kKey || !event.key) {
+    return;
+  }
+  const std::string key(event.key);
+  const data::LibraryTitleRange titles = library_.ByTitle();
+  ClampSelection(titles.size());
+  const size_t previous = selected_;
+  if (key == "back") {
     visible_ = false;
+  } else if (key == "up" && selected_ > 0) {
+    --selected_;
+  } else if (key == "down" && selected_ + 1 < titles.size()) {
+    ++selected_;
+  } else if (key == "left" && selected_ > 0) {
+    selected_ = library_.TitlesBetween("", LetterBound(titles[selected_ - 1], 0)).size();
+  } else if (key == "right" && selected_ < titles.size()) {
+    const size_t next = library_.TitlesBetween("", LetterBound(titles[selected_], 1)).size();
+    selected_ = std::min(next, titles.size() - 1);
+  }
+  if (selected_ != previous) {
+    AddDamage(kIndexPanel);
   }
 }
 
 void IndexScreen::Update(int /*dt_ms*/) {}
 
+void IndexScreen::ClampSelection(size_t title_count) {
+  // An empty library leaves selected_ at 0, which no branch moves and no
+  // row matches.
+  selected_ = title_count == 0 ? 0 : std::min(selected_, title_count - 1);
+}
+
 void IndexScreen::Render(ui::Renderer &renderer) {
   if (!visible_) {
     return;
   }
-  renderer.DrawRect(140, 120, ui::kBaseWidth - 280, ui::kBaseHeight - 240, ui::kColorPanel);
+  renderer.DrawPanel(kIndexPanel.x, kIndexPanel.y, kIndexPanel.w, kIndexPanel.h, ui::kColorPanel,
+                     ui::kPanelRadius);
+  const data::LibraryTitleRange titles = library_.ByTitle();
+  ClampSelection(titles.size());
+  const size_t first = (selected_ >= kIndexRows) ? selected_ - kIndexRows + 1 : 0;
+  for (size_t row = 0; row < kIndexRows && first + row < titles.size(); ++row) {
+    const int y = 132 + static_cast<int>(row) * (kIndexRowHeight + kIndexRowSpacing);
+    renderer.DrawRect(160, y, ui::kBaseWidth - 320, kIndexRowHeight, ui::kColorScrim);
+    if (first + row == selected_) {
+      renderer.DrawRectOutline(160, y, ui::kBaseWidth - 320, kIndexRowHeight, ui::kColorFocus, 2);
+    }
+  }
 }
 
 }  // namespace vita::scenes
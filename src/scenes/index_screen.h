@@ -1,5 +1,6 @@
 #pragma once
 
+#include "data/library.h"
 #include "data/state.h"
 #include "scenes/scene.h"
 
@@ -7,8 +8,9 @@ namespace vita::scenes {
 
 class IndexScreen : public Scene {
  public:
-  explicit IndexScreen(data::RuntimeState &state);
+  IndexScreen(const data::Library &library, data::RuntimeState &state);
 
+  const char *name() const override { return "index"; }
   void HandleEvent(const InputEvent &event) override;
   void Update(int dt_ms) override;
   void Render(ui::Renderer &renderer) override;
@@ -19,8 +21,13 @@ class IndexScreen : public Scene {
   void SetVisible(bool visible) { visible_ = visible; }
 
  private:
+  // Keeps `selected_` inside a title index that a hot reload may have shrunk.
+  void ClampSelection(size_t title_count);
+
+  const data::Library &library_;
   data::RuntimeState &state_;
   bool visible_ = false;
+  size_t selected_ = 0;
 };
 
 }  // namespace vita::scenes
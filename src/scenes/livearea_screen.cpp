@@ -1,45 +1,73 @@
 #include "scenes/livearea_screen.h"
 
 #include <chrono>
-#include <cstdlib>
 #include <string>
 
 #include "ui/constants.h"
 
 namespace vita::scenes {
 
-LiveAreaScreen::LiveAreaScreen(const data::LibraryItem &item, data::RuntimeState &state)
-    : item_(item), state_(state) {}
+namespace {
+
+constexpr SDL_Rect kHeroRect{(ui::kBaseWidth - ui::kHeroWidth) / 2, 80, ui::kHeroWidth,
+                             ui::kHeroHeight};
+constexpr SDL_Rect kGateRect{(ui::kBaseWidth - ui::kGateButtonWidth) / 2,
+                             kHeroRect.y + kHeroRect.h + 20, ui::kGateButtonWidth,
+                             ui::kGateButtonHeight};
+
+}  // namespace
+
+LiveAreaScreen::LiveAreaScreen(const data::Library &library, data::ItemId item_id,
+                               data::RuntimeState &state, data::ProcessSupervisor &processes)
+    : library_(library), item_id_(item_id), state_(state), processes_(processes) {}
 
 void LiveAreaScreen::HandleEvent(const InputEvent &event) {
   if (event.type == InputEvent::Type::kKey && event.key && std::string(event.key) == "accept") {
-    launching_ = true;
-    state_.last_played[item_.item_id] =
-        std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+    const data::LibraryItem *item = library_.Find(item_id_);
+    if (!item || item->cmd_linux.empty() || processes_.IsRunning(item_id_)) {
+      return;
+    }
+    std::string error;
+    if (!processes_.Launch(item_id_, item->cmd_linux, error)) {
+      state_.PushNotification({"Could not start " + item->title + ": " + error, item_id_});
+      return;
+    }
+    AddDamage(kGateRect);
+    state_.TouchLastPlayed(
+        item_id_,
+        std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count());
   }
 }
 
 void LiveAreaScreen::Update(int /*dt_ms*/) {
-  if (launching_ && !item_.cmd_linux.empty()) {
-    std::string command;
-    for (const auto &part : item_.cmd_linux) {
-      if (!command.empty()) {
-        command += " ";
-      }
-      command += part;
-    }
-    std::system(command.c_str());
-    launching_ = false;
+  if (images_ && hero_pending_ && images_->generation() != seen_image_generation_) {
+    seen_image_generation_ = images_->generation();
+    AddDamage(kHeroRect);
+  }
+  // Exits are reaped by the main loop; redraw the gate when they land.
+  if (processes_.IsRunning(item_id_) != shown_running_) {
+    AddDamage(kGateRect);
   }
 }
 
 void LiveAreaScreen::Render(ui::Renderer &renderer) {
   renderer.Clear(ui::kColorBackground);
-  const int hero_x = (ui::kBaseWidth - ui::kHeroWidth) / 2;
-  const int hero_y = 80;
-  renderer.DrawRect(hero_x, hero_y, ui::kHeroWidth, ui::kHeroHeight, ui::kColorPanel);
-  renderer.DrawRect((ui::kBaseWidth - ui::kGateButtonWidth) / 2, hero_y + ui::kHeroHeight + 20,
-                    ui::kGateButtonWidth, ui::kGateButtonHeight, ui::kColorFocus);
+  const data::LibraryItem *item = library_.Find(item_id_);
+  SDL_Texture *hero = (images_ && item)
+                          ? images_->Get(item->hero_path, ui::kHeroWidth, ui::kHeroHeight)
+                          : nullptr;
+  hero_pending_ = !hero && item && !item->hero_path.empty();
+  if (hero) {
+    renderer.DrawTexture(hero, kHeroRect);
+  } else {
+    renderer.DrawPanel(kHeroRect.x, kHeroRect.y, kHeroRect.w, kHeroRect.h, ui::kColorPanel,
+                       ui::kPanelRadius);
+  }
+  // The gate dims while the title is running.
+  shown_running_ = processes_.IsRunning(item_id_);
+  renderer.DrawPanel(kGateRect.x, kGateRect.y, kGateRect.w, kGateRect.h,
+                     shown_running_ ? ui::kColorDotInactive : ui::kColorFocus,
+                     ui::kGateButtonHeight / 2);
 }
 
 }  // namespace vita::scenes
@@ -1,23 +1,37 @@
 #pragma once
 
 #include "data/library.h"
+#include "data/process_supervisor.h"
 #include "data/state.h"
 #include "scenes/scene.h"
+#include "ui/image_pipeline.h"
 
 namespace vita::scenes {
 
 class LiveAreaScreen : public Scene {
  public:
-  LiveAreaScreen(const data::LibraryItem &item, data::RuntimeState &state);
+  // "accept" starts the title through `processes`; a failed launch is posted
+  // to the notifications instead.
+  LiveAreaScreen(const data::Library &library, data::ItemId item_id, data::RuntimeState &state,
+                 data::ProcessSupervisor &processes);
 
+  const char *name() const override { return "livearea"; }
   void HandleEvent(const InputEvent &event) override;
   void Update(int dt_ms) override;
   void Render(ui::Renderer &renderer) override;
 
+  // Draws the hero image from `images` once loaded; null keeps the panel.
+  void SetImages(ui::ImagePipeline *images) { images_ = images; }
+
  private:
-  const data::LibraryItem &item_;
+  const data::Library &library_;
+  data::ItemId item_id_;
   data::RuntimeState &state_;
-  bool launching_ = false;
+  data::ProcessSupervisor &processes_;
+  bool shown_running_ = false;
+  ui::ImagePipeline *images_ = nullptr;
+  uint64_t seen_image_generation_ = 0;
+  bool hero_pending_ = false;
 };
 
 }  // namespace vita::scenes
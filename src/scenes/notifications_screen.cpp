@@ -23,13 +23,14 @@ void NotificationsScreen::Render(ui::Renderer &renderer) {
   if (!visible_) {
     return;
   }
-  renderer.DrawRect(80, 80, ui::kBaseWidth - 160, ui::kBaseHeight - 160, ui::kColorPanel);
+  renderer.DrawPanel(80, 80, ui::kBaseWidth - 160, ui::kBaseHeight - 160, ui::kColorPanel,
+                     ui::kPanelRadius);
 }
 
 void NotificationsScreen::Toggle() {
   visible_ = !visible_;
   if (visible_) {
-    state_.notifications.clear();
+    state_.ClearNotifications();
   }
 }
 
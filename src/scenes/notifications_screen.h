@@ -9,6 +9,7 @@ class NotificationsScreen : public Scene {
  public:
   explicit NotificationsScreen(data::RuntimeState &state);
 
+  const char *name() const override { return "notifications"; }
   void HandleEvent(const InputEvent &event) override;
   void Update(int dt_ms) override;
   void Render(ui::Renderer &renderer) override;
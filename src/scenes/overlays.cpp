@@ -19,7 +19,8 @@ void QuickMenuOverlay::Render(ui::Renderer &renderer) {
     return;
   }
   renderer.DrawRect(0, 0, ui::kBaseWidth, ui::kBaseHeight, ui::kColorScrim);
-  renderer.DrawRect(200, 100, ui::kBaseWidth - 400, ui::kBaseHeight - 200, ui::kColorPanel);
+  renderer.DrawPanel(200, 100, ui::kBaseWidth - 400, ui::kBaseHeight - 200, ui::kColorPanel,
+                     ui::kPanelRadius);
 }
 
 }  // namespace vita::scenes
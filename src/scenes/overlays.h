@@ -6,6 +6,7 @@ namespace vita::scenes {
 
 class QuickMenuOverlay : public Scene {
  public:
+  const char *name() const override { return "quick_menu"; }
   void HandleEvent(const InputEvent &event) override;
   void Update(int dt_ms) override;
   void Render(ui::Renderer &renderer) override;
@@ -0,0 +1,93 @@
+#include "scenes/profiler_hud.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+
+#include "ui/constants.h"
+#include "ui/debug_font.h"
+
+namespace vita::scenes {
+
+namespace {
+
+constexpr int kHudRefreshMs = 250;
+constexpr int kHudScale = 2;
+constexpr int kHudMargin = 8;
+constexpr int kHudPadding = 8;
+constexpr int kHudRowHeight = (ui::kDebugGlyphHeight + 2) * kHudScale;
+constexpr int kHudColumns = 36;  // "%-14s %-6s %6.2f %6.2f"
+constexpr int kHudWidth = kHudColumns * (ui::kDebugGlyphWidth + 1) * kHudScale + 2 * kHudPadding;
+
+constexpr SDL_Color kHudText{255, 255, 255, 255};
+constexpr SDL_Color kHudHeader{183, 189, 201, 255};
+constexpr SDL_Color kHudSlow{255, 120, 96, 255};
+constexpr double kHudSlowMs = 1000.0 / 60.0;
+
+}  // namespace
+
+ProfilerHud::ProfilerHud(ui::Profiler &profiler) : profiler_(profiler) {}
+
+void ProfilerHud::HandleEvent(const InputEvent & /*event*/) {}
+
+void ProfilerHud::Toggle() {
+  visible_ = !visible_;
+  if (visible_) {
+    Refresh();
+  }
+}
+
+void ProfilerHud::Update(int dt_ms) {
+  if (!visible_) {
+    return;
+  }
+  refresh_timer_ms_ -= dt_ms;
+  if (refresh_timer_ms_ <= 0) {
+    Refresh();
+  }
+}
+
+std::optional<int> ProfilerHud::NextDeadlineMs() const {
+  if (!visible_) {
+    return std::nullopt;
+  }
+  return std::max(0, refresh_timer_ms_);
+}
+
+void ProfilerHud::Refresh() {
+  profiler_.Collect();
+  summaries_ = profiler_.Summaries();
+  refresh_timer_ms_ = kHudRefreshMs;
+  // The panel grows with the number of scopes; repaint both extents.
+  AddDamage(rect_);
+  const int rows = static_cast<int>(summaries_.size()) + 1;
+  rect_ = SDL_Rect{ui::kBaseWidth - kHudWidth - kHudMargin, kHudMargin, kHudWidth,
+                   std::min(ui::kBaseHeight - 2 * kHudMargin,
+                            rows * kHudRowHeight + 2 * kHudPadding)};
+  AddDamage(rect_);
+}
+
+void ProfilerHud::Render(ui::Renderer &renderer) {
+  if (!visible_) {
+    return;
+  }
+  renderer.DrawPanel(rect_.x, rect_.y, rect_.w, rect_.h, ui::kColorScrim, ui::kPanelRadius / 2);
+  const int x = rect_.x + kHudPadding;
+  int y = rect_.y + kHudPadding;
+  char line[64];
+  std::snprintf(line, sizeof(line), "%-14s %-6s %6s %6s", "scope", "phase", "p50", "p99");
+  ui::DrawDebugText(renderer, x, y, line, kHudHeader, kHudScale);
+  for (const auto &summary : summaries_) {
+    y += kHudRowHeight;
+    if (y + kHudRowHeight > rect_.y + rect_.h) {
+      break;
+    }
+    std::snprintf(line, sizeof(line), "%-14.14s %-6.6s %6.2f %6.2f",
+                  std::string(summary.name).c_str(), std::string(summary.category).c_str(),
+                  summary.p50_ms, summary.p99_ms);
+    ui::DrawDebugText(renderer, x, y, line, summary.p99_ms > kHudSlowMs ? kHudSlow : kHudText,
+                      kHudScale);
+  }
+}
+
+}  // namespace vita::scenes
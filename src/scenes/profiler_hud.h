@@ -0,0 +1,36 @@
+#pragma once
+
+#include <vector>
+
+#include "scenes/scene.h"
+#include "ui/profiler.h"
+
+namespace vita::scenes {
+
+// Debug overlay listing rolling p50/p99 timings for every profiled scope.
+// It never takes input and refreshes a few times a second while shown.
+class ProfilerHud : public Scene {
+ public:
+  explicit ProfilerHud(ui::Profiler &profiler);
+
+  const char *name() const override { return "profiler_hud"; }
+  void HandleEvent(const InputEvent &event) override;
+  void Update(int dt_ms) override;
+  void Render(ui::Renderer &renderer) override;
+  bool IsVisible() const override { return visible_; }
+  bool AcceptsInput() const override { return false; }
+  std::optional<int> NextDeadlineMs() const override;
+
+  void Toggle();
+
+ private:
+  ui::Profiler &profiler_;
+  std::vector<ui::Profiler::Summary> summaries_;
+  bool visible_ = false;
+  int refresh_timer_ms_ = 0;
+  SDL_Rect rect_{0, 0, 0, 0};
+
+  void Refresh();
+};
+
+}  // namespace vita::scenes
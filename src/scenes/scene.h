@@ -1,5 +1,9 @@
 #pragma once
 
+#include <optional>
+#include <utility>
+
+#include "ui/damage.h"
 #include "ui/renderer.h"
 
 namespace vita::scenes {
@@ -17,11 +21,26 @@ struct InputEvent {
 class Scene {
  public:
   virtual ~Scene() = default;
+  // Stable label for profiling; must outlive the scene (a string literal).
+  virtual const char *name() const = 0;
   virtual void HandleEvent(const InputEvent &event) = 0;
   virtual void Update(int dt_ms) = 0;
   virtual void Render(ui::Renderer &renderer) = 0;
   virtual bool IsVisible() const { return true; }
   virtual bool AcceptsInput() const { return IsVisible(); }
+  // Returns what changed on screen since the last call and forgets it.
+  // Scenes start fully damaged so their first frame is drawn.
+  virtual ui::DamageRegion TakeDamage() { return std::exchange(damage_, ui::DamageRegion{}); }
+  void DamageAll() { damage_.AddAll(); }
+  // Milliseconds until the scene needs an Update without any input (a timer
+  // expiring; 0 while animating), or nullopt when it can sleep indefinitely.
+  virtual std::optional<int> NextDeadlineMs() const { return std::nullopt; }
+
+ protected:
+  void AddDamage(const SDL_Rect &rect) { damage_.Add(rect); }
+
+ private:
+  ui::DamageRegion damage_ = ui::DamageRegion::All();
 };
 
 }  // namespace vita::scenes
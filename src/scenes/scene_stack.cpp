@@ -1,20 +1,28 @@
 #include "scenes/scene_stack.h"
 
+#include <optional>
+#include <utility>
+
 namespace vita::scenes {
 
 void SceneStack::Push(Scene *scene) {
   stack_.push_back(scene);
+  was_visible_.push_back(false);
+  damage_.AddAll();
 }
 
 void SceneStack::Pop() {
   if (!stack_.empty()) {
     stack_.pop_back();
+    was_visible_.pop_back();
+    damage_.AddAll();
   }
 }
 
 void SceneStack::HandleEvent(const InputEvent &event) {
   for (auto iter = stack_.rbegin(); iter != stack_.rend(); ++iter) {
     if ((*iter)->AcceptsInput()) {
+      ui::ProfileScope scope(profiler_, (*iter)->name(), "event");
       (*iter)->HandleEvent(event);
       break;
     }
@@ -23,16 +31,49 @@ void SceneStack::HandleEvent(const InputEvent &event) {
 
 void SceneStack::Update(int dt_ms) {
   for (auto *scene : stack_) {
+    ui::ProfileScope scope(profiler_, scene->name(), "update");
     scene->Update(dt_ms);
   }
 }
 
-void SceneStack::Render(ui::Renderer &renderer) {
+std::optional<int> SceneStack::NextDeadlineMs() const {
+  std::optional<int> earliest;
+  for (const auto *scene : stack_) {
+    const std::optional<int> deadline = scene->NextDeadlineMs();
+    if (deadline && (!earliest || *deadline < *earliest)) {
+      earliest = deadline;
+    }
+  }
+  return earliest;
+}
+
+bool SceneStack::Render(ui::Renderer &renderer) {
+  ui::DamageRegion damage = std::exchange(damage_, ui::DamageRegion{});
+  for (size_t index = 0; index < stack_.size(); ++index) {
+    Scene *scene = stack_[index];
+    const bool visible = scene->IsVisible();
+    // Showing or hiding a scene uncovers whatever it overlapped.
+    if (visible != was_visible_[index]) {
+      damage.AddAll();
+      was_visible_[index] = visible;
+    }
+    const ui::DamageRegion scene_damage = scene->TakeDamage();
+    if (visible) {
+      damage.Add(scene_damage);
+    }
+  }
+  if (!damage.any) {
+    return false;
+  }
+  renderer.SetClip(damage.full() ? nullptr : &damage.bounds);
   for (auto *scene : stack_) {
     if (scene->IsVisible()) {
+      ui::ProfileScope scope(profiler_, scene->name(), "render");
       scene->Render(renderer);
     }
   }
+  renderer.SetClip(nullptr);
+  return true;
 }
 
 }  // namespace vita::scenes
@@ -3,6 +3,7 @@
 #include <vector>
 
 #include "scenes/scene.h"
+#include "ui/profiler.h"
 
 namespace vita::scenes {
 
@@ -12,10 +13,22 @@ class SceneStack {
   void Pop();
   void HandleEvent(const InputEvent &event);
   void Update(int dt_ms);
-  void Render(ui::Renderer &renderer);
+  // Repaints only the union of what the scenes report as damaged, clipped
+  // to it, and returns false without drawing anything when nothing changed.
+  bool Render(ui::Renderer &renderer);
+  // Forces a full repaint, e.g. after the render target's contents are lost.
+  void DamageAll() { damage_.AddAll(); }
+  // Earliest NextDeadlineMs() over all scenes.
+  std::optional<int> NextDeadlineMs() const;
+  // Times each scene's HandleEvent/Update/Render under its name(); null
+  // disables profiling.
+  void SetProfiler(ui::Profiler *profiler) { profiler_ = profiler; }
 
  private:
   std::vector<Scene *> stack_;
+  std::vector<bool> was_visible_;
+  ui::DamageRegion damage_ = ui::DamageRegion::All();
+  ui::Profiler *profiler_ = nullptr;
 };
 
 }  // namespace vita::scenes
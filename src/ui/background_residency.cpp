@@ -0,0 +1,81 @@
+#include "ui/background_residency.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace vita::ui {
+
+BackgroundResidency::BackgroundResidency(ImagePipeline &images, uintmax_t budget_bytes)
+    : images_(images), budget_bytes_(budget_bytes) {}
+
+SDL_Texture *BackgroundResidency::Get(const data::RuntimeState &state, int page) const {
+  const auto iter = state.page_backgrounds.find(page);
+  if (iter == state.page_backgrounds.end()) {
+    return nullptr;
+  }
+  return images_.Find(iter->second, kBaseWidth, kBaseHeight);
+}
+
+void BackgroundResidency::Update(const data::RuntimeState &state) {
+  const int current = state.current_page;
+  if (current != seen_page_) {
+    seen_page_ = current;
+    if (state.page_backgrounds.count(current) != 0) {
+      ++(Get(state, current) ? stats_.hits : stats_.misses);
+    }
+  }
+
+  for (auto &[path, entry] : entries_) {
+    entry.pinned = false;
+  }
+  // Current page first so it is decoded ahead of its neighbours.
+  ++use_clock_;
+  for (const int page : {current, current + 1, current - 1}) {
+    const auto iter = state.page_backgrounds.find(page);
+    if (iter == state.page_backgrounds.end() || iter->second.empty()) {
+      continue;
+    }
+    const auto [entry, inserted] = entries_.try_emplace(iter->second);
+    if (inserted && page != current) {
+      ++stats_.prefetches;
+    }
+    if (page == current) {
+      entry->second.last_used = use_clock_;
+    }
+    entry->second.pinned = true;
+    images_.Get(iter->second, kBaseWidth, kBaseHeight);
+  }
+  Evict();
+}
+
+void BackgroundResidency::Evict() {
+  std::vector<std::pair<uint64_t, std::string>> candidates;
+  size_t resident = 0;
+  for (const auto &[path, entry] : entries_) {
+    if (images_.Find(path, kBaseWidth, kBaseHeight)) {
+      ++resident;
+    }
+    if (!entry.pinned) {
+      candidates.emplace_back(entry.last_used, path);
+    }
+  }
+  std::sort(candidates.begin(), candidates.end());
+  for (const auto &[last_used, path] : candidates) {
+    const bool loaded = images_.Find(path, kBaseWidth, kBaseHeight) != nullptr;
+    // Prefetches for pages no longer adjacent are cancelled outright;
+    // loaded textures stay until the budget is exceeded.
+    if (loaded && resident * kTextureBytes <= budget_bytes_) {
+      continue;
+    }
+    images_.Release(path, kBaseWidth, kBaseHeight);
+    entries_.erase(path);
+    if (loaded) {
+      --resident;
+      ++stats_.evictions;
+    }
+  }
+  stats_.resident = resident;
+  stats_.resident_bytes = resident * kTextureBytes;
+}
+
+}  // namespace vita::ui
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <SDL.h>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include "data/state.h"
+#include "ui/constants.h"
+#include "ui/image_pipeline.h"
+
+namespace vita::ui {
+
+// Keeps page backgrounds (RuntimeState::page_backgrounds) uploaded around
+// the current page so a page flip never waits on I/O. Update() runs once
+// per frame: it requests the current page's background and then both
+// neighbours through the image pipeline, so they decode in the background
+// ahead of a swipe. Backgrounds of pages further away stay resident as a
+// cache until their textures push past `budget_bytes`, then the least
+// recently shown go first; the current page and its neighbours are never
+// evicted.
+class BackgroundResidency {
+ public:
+  static constexpr uintmax_t kDefaultBudgetBytes = 24 * 1024 * 1024;
+
+  struct Stats {
+    // Page flips whose background was (not) already resident.
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t prefetches = 0;
+    uint64_t evictions = 0;
+    size_t resident = 0;
+    uintmax_t resident_bytes = 0;
+  };
+
+  explicit BackgroundResidency(ImagePipeline &images,
+                               uintmax_t budget_bytes = kDefaultBudgetBytes);
+
+  void Update(const data::RuntimeState &state);
+  // The background texture for `page`, or nullptr when it has none or it is
+  // not loaded yet.
+  SDL_Texture *Get(const data::RuntimeState &state, int page) const;
+  const Stats &stats() const { return stats_; }
+
+ private:
+  static constexpr uintmax_t kTextureBytes = static_cast<uintmax_t>(kBaseWidth) * kBaseHeight * 4;
+
+  struct Entry {
+    uint64_t last_used = 0;
+    bool pinned = false;
+  };
+
+  ImagePipeline &images_;
+  uintmax_t budget_bytes_;
+  // Requested backgrounds by path; several pages may share one.
+  std::unordered_map<std::string, Entry> entries_;
+  uint64_t use_clock_ = 0;
+  int seen_page_ = -1;
+  Stats stats_;
+
+  void Evict();
+};
+
+}  // namespace vita::ui
@@ -24,6 +24,9 @@ constexpr int kGridLeft = 60;
 constexpr int kHeroWidth = 720;
 constexpr int kHeroHeight = 405;
 
+constexpr int kPanelRadius = 12;
+constexpr int kIconRadius = kIconSize / 2;
+
 constexpr int kGateButtonWidth = 240;
 constexpr int kGateButtonHeight = 64;
 
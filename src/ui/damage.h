@@ -0,0 +1,50 @@
+#pragma once
+
+#include <SDL.h>
+
+#include <algorithm>
+
+#include "ui/constants.h"
+
+namespace vita::ui {
+
+// Bounding box of the parts of the virtual canvas that need repainting.
+struct DamageRegion {
+  bool any = false;
+  SDL_Rect bounds{0, 0, 0, 0};
+
+  static DamageRegion All() {
+    DamageRegion region;
+    region.AddAll();
+    return region;
+  }
+
+  void Add(const SDL_Rect &rect) {
+    const int left = std::max(rect.x, 0);
+    const int top = std::max(rect.y, 0);
+    const int right = std::min(rect.x + rect.w, kBaseWidth);
+    const int bottom = std::min(rect.y + rect.h, kBaseHeight);
+    if (right <= left || bottom <= top) {
+      return;
+    }
+    if (!any) {
+      bounds = {left, top, right - left, bottom - top};
+      any = true;
+      return;
+    }
+    const int merged_left = std::min(bounds.x, left);
+    const int merged_top = std::min(bounds.y, top);
+    const int merged_right = std::max(bounds.x + bounds.w, right);
+    const int merged_bottom = std::max(bounds.y + bounds.h, bottom);
+    bounds = {merged_left, merged_top, merged_right - merged_left, merged_bottom - merged_top};
+  }
+  void Add(const DamageRegion &other) {
+    if (other.any) {
+      Add(other.bounds);
+    }
+  }
+  void AddAll() { Add(SDL_Rect{0, 0, kBaseWidth, kBaseHeight}); }
+  bool full() const { return any && bounds.w == kBaseWidth && bounds.h == kBaseHeight; }
+};
+
+}  // namespace vita::ui
@@ -0,0 +1,103 @@
+#include "ui/debug_font.h"
+
+#include <array>
+#include <cstdint>
+
+namespace vita::ui {
+namespace {
+
+using Glyph = std::array<uint8_t, kDebugGlyphHeight>;  // rows, top bit is the left column
+
+constexpr std::array<Glyph, 10> kDigits{{
+    {0b111, 0b101, 0b101, 0b101, 0b111}, {0b010, 0b110, 0b010, 0b010, 0b111},
+    {0b111, 0b001, 0b111, 0b100, 0b111}, {0b111, 0b001, 0b111, 0b001, 0b111},
+    {0b101, 0b101, 0b111, 0b001, 0b001}, {0b111, 0b100, 0b111, 0b001, 0b111},
+    {0b111, 0b100, 0b111, 0b101, 0b111}, {0b111, 0b001, 0b001, 0b001, 0b001},
+    {0b111, 0b101, 0b111, 0b101, 0b111}, {0b111, 0b101, 0b111, 0b001, 0b111},
+}};
+
+constexpr std::array<Glyph, 26> kLetters{{
+    {0b010, 0b101, 0b111, 0b101, 0b101}, {0b110, 0b101, 0b110, 0b101, 0b110},
+    {0b011, 0b100, 0b100, 0b100, 0b011}, {0b110, 0b101, 0b101, 0b101, 0b110},
+    {0b111, 0b100, 0b110, 0b100, 0b111}, {0b111, 0b100, 0b110, 0b100, 0b100},
+    {0b011, 0b100, 0b101, 0b101, 0b011}, {0b101, 0b101, 0b111, 0b101, 0b101},
+    {0b111, 0b010, 0b010, 0b010, 0b111}, {0b001, 0b001, 0b001, 0b101, 0b010},
+    {0b101, 0b101, 0b110, 0b101, 0b101}, {0b100, 0b100, 0b100, 0b100, 0b111},
+    {0b101, 0b111, 0b111, 0b101, 0b101}, {0b110, 0b101, 0b101, 0b101, 0b101},
+    {0b010, 0b101, 0b101, 0b101, 0b010}, {0b110, 0b101, 0b110, 0b100, 0b100},
+    {0b010, 0b101, 0b101, 0b110, 0b011}, {0b110, 0b101, 0b110, 0b101, 0b101},
+    {0b011, 0b100, 0b010, 0b001, 0b110}, {0b111, 0b010, 0b010, 0b010, 0b010},
+    {0b101, 0b101, 0b101, 0b101, 0b111}, {0b101, 0b101, 0b101, 0b101, 0b010},
+    {0b101, 0b101, 0b111, 0b111, 0b101}, {0b101, 0b101, 0b010, 0b101, 0b101},
+    {0b101, 0b101, 0b010, 0b010, 0b010}, {0b111, 0b001, 0b010, 0b100, 0b111},
+}};
+
+const Glyph *FindGlyph(char c) {
+  static constexpr Glyph kPeriod{0b000, 0b000, 0b000, 0b000, 0b010};
+  static constexpr Glyph kColon{0b000, 0b010, 0b000, 0b010, 0b000};
+  static constexpr Glyph kMinus{0b000, 0b000, 0b111, 0b000, 0b000};
+  static constexpr Glyph kUnderscore{0b000, 0b000, 0b000, 0b000, 0b111};
+  static constexpr Glyph kSlash{0b001, 0b001, 0b010, 0b100, 0b100};
+  static constexpr Glyph kPercent{0b101, 0b001, 0b010, 0b100, 0b101};
+  if (c >= '0' && c <= '9') {
+    return &kDigits[c - '0'];
+  }
+  if (c >= 'a' && c <= 'z') {
+    c = static_cast<char>(c - 'a' + 'A');
+  }
+  if (c >= 'A' && c <= 'Z') {
+    return &kLetters[c - 'A'];
+  }
+  switch (c) {
+    case '.':
+      return &kPeriod;
+    case ':':
+      return &kColon;
+    case '-':
+      return &kMinus;
+    case '_':
+      return &kUnderscore;
+    case '/':
+      return &kSlash;
+    case '%':
+      return &kPercent;
+    default:
+      return nullptr;
+  }
+}
+
+}  // namespace
+
+int DrawDebugText(Renderer &renderer, int x, int y, std::string_view text, const SDL_Color &color,
+                  int scale) {
+  const int advance = (kDebugGlyphWidth + 1) * scale;
+  int pen = x;
+  for (const char c : text) {
+    if (const Glyph *glyph = FindGlyph(c)) {
+      for (int row = 0; row < kDebugGlyphHeight; ++row) {
+        // Merge horizontal runs so a row costs at most two quads.
+        int column = 0;
+        while (column < kDebugGlyphWidth) {
+          const auto lit = [&](int col) {
+            return ((*glyph)[row] >> (kDebugGlyphWidth - 1 - col)) & 1;
+          };
+          if (!lit(column)) {
+            ++column;
+            continue;
+          }
+          int end = column + 1;
+          while (end < kDebugGlyphWidth && lit(end)) {
+            ++end;
+          }
+          renderer.DrawRect(pen + column * scale, y + row * scale, (end - column) * scale, scale,
+                            color);
+          column = end;
+        }
+      }
+    }
+    pen += advance;
+  }
+  return pen - x;
+}
+
+}  // namespace vita::ui
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <SDL.h>
+
+#include <string_view>
+
+#include "ui/renderer.h"
+
+namespace vita::ui {
+
+constexpr int kDebugGlyphWidth = 3;
+constexpr int kDebugGlyphHeight = 5;
+
+// Draws `text` with a built-in 3x5 pixel font scaled by `scale`, for debug
+// overlays that cannot depend on font assets. Letters are drawn uppercase;
+// characters without a glyph are left blank. Returns the advance in pixels.
+int DrawDebugText(Renderer &renderer, int x, int y, std::string_view text, const SDL_Color &color,
+                  int scale = 2);
+
+}  // namespace vita::ui
@@ -0,0 +1,94 @@
+#include "ui/frame_scheduler.h"
+
+#include <algorithm>
+#include <charconv>
+#include <utility>
+
+namespace vita::ui {
+
+FrameScheduler::FrameScheduler(Policy policy, int fps_cap)
+    : policy_(policy),
+      frame_period_(std::chrono::duration_cast<Clock::duration>(
+          std::chrono::duration<double>(1.0 / std::max(1, fps_cap)))),
+      last_frame_(Clock::now()),
+      window_start_(last_frame_) {}
+
+std::optional<FrameScheduler> FrameScheduler::FromString(std::string_view value) {
+  if (value == "vsync") {
+    return FrameScheduler(Policy::kVsync, 60);
+  }
+  if (value == "unlimited") {
+    return FrameScheduler(Policy::kUnlimited, 60);
+  }
+  int fps = 0;
+  const auto result = std::from_chars(value.data(), value.data() + value.size(), fps);
+  if (result.ec != std::errc() || result.ptr != value.data() + value.size() || fps <= 0) {
+    return std::nullopt;
+  }
+  return FrameScheduler(Policy::kCapped, fps);
+}
+
+uint32_t FrameScheduler::renderer_flags() const {
+  uint32_t flags = SDL_RENDERER_ACCELERATED;
+  if (policy_ == Policy::kVsync) {
+    flags |= SDL_RENDERER_PRESENTVSYNC;
+  }
+  return flags;
+}
+
+void FrameScheduler::WakeAt(Clock::time_point deadline) {
+  if (!deadline_ || deadline < *deadline_) {
+    deadline_ = deadline;
+  }
+}
+
+bool FrameScheduler::WaitForEvent(SDL_Event &event, bool drawing) {
+  std::optional<Clock::time_point> wake = std::exchange(deadline_, std::nullopt);
+  if (drawing) {
+    if (policy_ != Policy::kCapped) {
+      // Vsync blocks in SDL_RenderPresent; unlimited never blocks.
+      return SDL_PollEvent(&event) == 1;
+    }
+    const Clock::time_point next_frame = last_frame_ + frame_period_;
+    wake = wake ? std::min(*wake, next_frame) : next_frame;
+  }
+
+  const Clock::time_point start = Clock::now();
+  bool received = false;
+  if (!wake) {
+    received = SDL_WaitEvent(&event) == 1;
+  } else if (*wake <= start) {
+    received = SDL_PollEvent(&event) == 1;
+  } else {
+    // Round up so the loop does not wake a hair early and wait again.
+    const auto timeout = std::chrono::ceil<std::chrono::milliseconds>(*wake - start);
+    received = SDL_WaitEventTimeout(&event, static_cast<int>(timeout.count())) == 1;
+  }
+  const Clock::time_point end = Clock::now();
+  window_slept_ += end - start;
+  stats_.slept_ms += std::chrono::duration<double, std::milli>(end - start).count();
+  RollWindow(end);
+  return received;
+}
+
+void FrameScheduler::FramePresented() {
+  last_frame_ = Clock::now();
+  ++stats_.frames;
+  ++window_frames_;
+  RollWindow(last_frame_);
+}
+
+void FrameScheduler::RollWindow(Clock::time_point now) {
+  const auto elapsed = now - window_start_;
+  if (elapsed < std::chrono::seconds(1)) {
+    return;
+  }
+  const double seconds = std::chrono::duration<double>(elapsed).count();
+  stats_.fps = static_cast<double>(window_frames_) / seconds;
+  stats_.sleep_ratio = std::chrono::duration<double>(window_slept_).count() / seconds;
+  window_start_ = now;
+  window_frames_ = 0;
+  window_slept_ = Clock::duration::zero();
+}
+
+}  // namespace vita::ui
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <SDL.h>
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace vita::ui {
+
+// Decides how long the main loop may block before its next pass. While
+// frames are being drawn the policy paces them: kVsync relies on a vsynced
+// SDL_RenderPresent, kCapped sleeps until the next frame slot, kUnlimited
+// never waits. When the last pass drew nothing the loop blocks in the event
+// queue until input arrives or the earliest deadline registered with
+// WakeAt() is reached, whichever is first.
+class FrameScheduler {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  enum class Policy {
+    kVsync,
+    kCapped,
+    kUnlimited,
+  };
+
+  struct Stats {
+    uint64_t frames = 0;
+    double fps = 0.0;          // presented frames per second, last full second
+    double sleep_ratio = 0.0;  // share of the last full second spent waiting
+    double slept_ms = 0.0;     // total
+  };
+
+  FrameScheduler(Policy policy, int fps_cap);
+
+  // Parses "vsync", "unlimited" or a frame rate such as "60".
+  static std::optional<FrameScheduler> FromString(std::string_view value);
+
+  Policy policy() const { return policy_; }
+  // SDL_CreateRenderer flags matching the policy.
+  uint32_t renderer_flags() const;
+
+  // Deadlines only apply to the next wait; register them every pass.
+  void WakeAt(Clock::time_point deadline);
+  void WakeIn(int ms) { WakeAt(Clock::now() + std::chrono::milliseconds(ms)); }
+  // Fetches the first event of the next pass, blocking as the policy allows.
+  // `drawing` is whether the previous pass drew a frame.
+  bool WaitForEvent(SDL_Event &event, bool drawing);
+  void FramePresented();
+  const Stats &stats() const { return stats_; }
+
+ private:
+  Policy policy_;
+  Clock::duration frame_period_;
+  std::optional<Clock::time_point> deadline_;
+  Clock::time_point last_frame_;
+
+  Stats stats_;
+  Clock::time_point window_start_;
+  uint64_t window_frames_ = 0;
+  Clock::duration window_slept_{0};
+
+  void RollWindow(Clock::time_point now);
+};
+
+}  // namespace vita::ui
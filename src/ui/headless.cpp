@@ -0,0 +1,54 @@
+#include "ui/headless.h"
+
+#include <stdexcept>
+#include <string>
+
+#include "data/file_util.h"
+
+namespace vita::ui {
+
+HeadlessTarget::HeadlessTarget(int width, int height) {
+  surface_ = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_ARGB8888);
+  if (!surface_) {
+    throw std::runtime_error(std::string("Failed to create headless surface: ") + SDL_GetError());
+  }
+  renderer_ = SDL_CreateSoftwareRenderer(surface_);
+  if (!renderer_) {
+    const std::string error = SDL_GetError();
+    SDL_FreeSurface(surface_);
+    throw std::runtime_error("Failed to create software renderer: " + error);
+  }
+}
+
+HeadlessTarget::~HeadlessTarget() {
+  SDL_DestroyRenderer(renderer_);
+  SDL_FreeSurface(surface_);
+}
+
+bool HeadlessTarget::Save(const std::filesystem::path &path) const {
+  if (path.extension() == ".ppm") {
+    return SavePpm(path);
+  }
+  return SDL_SaveBMP(surface_, path.string().c_str()) == 0;
+}
+
+bool HeadlessTarget::SavePpm(const std::filesystem::path &path) const {
+  SDL_Surface *rgb = SDL_ConvertSurfaceFormat(surface_, SDL_PIXELFORMAT_RGB24, 0);
+  if (!rgb) {
+    return false;
+  }
+  std::string contents =
+      "P6\n" + std::to_string(rgb->w) + " " + std::to_string(rgb->h) + "\n255\n";
+  const size_t row_bytes = static_cast<size_t>(rgb->w) * 3;
+  contents.reserve(contents.size() + row_bytes * rgb->h);
+  SDL_LockSurface(rgb);
+  const auto *pixels = static_cast<const char *>(rgb->pixels);
+  for (int y = 0; y < rgb->h; ++y) {
+    contents.append(pixels + static_cast<size_t>(y) * rgb->pitch, row_bytes);
+  }
+  SDL_UnlockSurface(rgb);
+  SDL_FreeSurface(rgb);
+  return data::WriteFileAtomic(path, contents);
+}
+
+}  // namespace vita::ui
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <SDL.h>
+
+#include <filesystem>
+
+#include "ui/constants.h"
+
+namespace vita::ui {
+
+// An SDL software renderer drawing into a CPU surface, for running scenes
+// without a window or GPU (benchmarks, CI). Needs no SDL video subsystem.
+// Throws std::runtime_error if SDL cannot create the surface or renderer.
+class HeadlessTarget {
+ public:
+  explicit HeadlessTarget(int width = kBaseWidth, int height = kBaseHeight);
+  ~HeadlessTarget();
+
+  HeadlessTarget(const HeadlessTarget &) = delete;
+  HeadlessTarget &operator=(const HeadlessTarget &) = delete;
+
+  SDL_Renderer *renderer() const { return renderer_; }
+  SDL_Surface *surface() const { return surface_; }
+
+  // Writes the current frame as binary PPM when `path` ends in .ppm,
+  // otherwise as BMP.
+  bool Save(const std::filesystem::path &path) const;
+
+ private:
+  SDL_Surface *surface_ = nullptr;
+  SDL_Renderer *renderer_ = nullptr;
+
+  bool SavePpm(const std::filesystem::path &path) const;
+};
+
+}  // namespace vita::ui
@@ -0,0 +1,309 @@
+#include "ui/image_pipeline.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+#include <utility>
+
+#include "data/file_util.h"
+#include "data/mapped_file.h"
+
+#ifdef VITA_SHELL_HAS_SDL_IMAGE
+#include <SDL_image.h>
+#endif
+
+namespace vita::ui {
+namespace {
+
+// Decodes an encoded image held in memory into an ARGB8888 surface, or
+// returns nullptr.
+SDL_Surface *DecodeImage(std::string_view bytes) {
+  SDL_RWops *stream = SDL_RWFromConstMem(bytes.data(), static_cast<int>(bytes.size()));
+  if (!stream) {
+    return nullptr;
+  }
+#ifdef VITA_SHELL_HAS_SDL_IMAGE
+  SDL_Surface *raw = IMG_Load_RW(stream, 1);
+#else
+  SDL_Surface *raw = SDL_LoadBMP_RW(stream, 1);
+#endif
+  if (!raw) {
+    return nullptr;
+  }
+  SDL_Surface *converted = SDL_ConvertSurfaceFormat(raw, SDL_PIXELFORMAT_ARGB8888, 0);
+  SDL_FreeSurface(raw);
+  return converted;
+}
+
+// Stretches `surface` to width x height, consuming it.
+SDL_Surface *ScaleImage(SDL_Surface *surface, int width, int height) {
+  if (surface->w == width && surface->h == height) {
+    return surface;
+  }
+  SDL_Surface *scaled =
+      SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_ARGB8888);
+  if (scaled) {
+#if SDL_VERSION_ATLEAST(2, 0, 16)
+    const int result = SDL_SoftStretchLinear(surface, nullptr, scaled, nullptr);
+#else
+    const int result = SDL_SoftStretch(surface, nullptr, scaled, nullptr);
+#endif
+    if (result != 0) {
+      SDL_FreeSurface(scaled);
+      scaled = nullptr;
+    }
+  }
+  SDL_FreeSurface(surface);
+  return scaled;
+}
+
+}  // namespace
+
+ImagePipeline::ImagePipeline(SDL_Renderer *renderer, size_t workers,
+                             std::function<void()> on_decoded, Profiler *profiler,
+                             ThumbnailCache *thumbnails)
+    : renderer_(renderer),
+      on_decoded_(std::move(on_decoded)),
+      profiler_(profiler),
+      thumbnails_(thumbnails) {
+#ifdef VITA_SHELL_HAS_SDL_IMAGE
+  // Load the codecs up front; IMG_Load would otherwise do it lazily from
+  // several workers at once.
+  IMG_Init(IMG_INIT_PNG | IMG_INIT_JPG);
+#endif
+  if (workers == 0) {
+    workers = std::clamp<size_t>(std::thread::hardware_concurrency() / 2, 1, 4);
+  }
+  for (size_t index = 0; index < workers; ++index) {
+    workers_.emplace_back([this] { Run(); });
+  }
+}
+
+ImagePipeline::~ImagePipeline() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+  for (const auto &decoded : decoded_) {
+    SDL_FreeSurface(decoded.surface);
+  }
+  for (const auto &decoded : ready_) {
+    SDL_FreeSurface(decoded.surface);
+  }
+  for (const auto &[key, entry] : entries_) {
+    if (entry.texture) {
+      SDL_DestroyTexture(entry.texture);
+    }
+  }
+}
+
+std::string ImagePipeline::Key(const std::string &path, int width, int height) {
+  if (width > 0 && height > 0) {
+    return path + "@" + std::to_string(width) + "x" + std::to_string(height);
+  }
+  return path;
+}
+
+SDL_Texture *ImagePipeline::Get(const std::string &path, int width, int height) {
+  if (path.empty()) {
+    return nullptr;
+  }
+  std::string key = Key(path, width, height);
+  const auto [iter, inserted] = entries_.try_emplace(key);
+  if (inserted) {
+    iter->second.request = {std::move(key), path, std::max(width, 0), std::max(height, 0)};
+    iter->second.requested = Clock::now();
+    ++stats_.requested;
+    Enqueue(iter->second.request);
+  }
+  return iter->second.texture;
+}
+
+SDL_Texture *ImagePipeline::Find(const std::string &path, int width, int height) const {
+  const auto iter = entries_.find(Key(path, width, height));
+  return iter == entries_.end() ? nullptr : iter->second.texture;
+}
+
+void ImagePipeline::Release(const std::string &path, int width, int height) {
+  const auto iter = entries_.find(Key(path, width, height));
+  if (iter == entries_.end()) {
+    return;
+  }
+  if (iter->second.texture) {
+    SDL_DestroyTexture(iter->second.texture);
+  } else {
+    // Still queued: skip the decode. One already running is dropped by
+    // Upload() since its entry is gone.
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.erase(std::remove_if(queue_.begin(), queue_.end(),
+                                [&](const Request &request) { return request.key == iter->first; }),
+                 queue_.end());
+  }
+  entries_.erase(iter);
+}
+
+void ImagePipeline::Enqueue(Request request) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.push_back(std::move(request));
+  }
+  wake_.notify_one();
+}
+
+bool ImagePipeline::has_pending_uploads() const {
+  if (!ready_.empty()) {
+    return true;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  return !decoded_.empty();
+}
+
+int ImagePipeline::Upload(int max_uploads, double budget_ms) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto &decoded : decoded_) {
+      ready_.push_back(std::move(decoded));
+    }
+    decoded_.clear();
+  }
+  ProfileScope scope(ready_.empty() ? nullptr : profiler_, "images", "upload");
+  const auto start = Clock::now();
+  int uploaded = 0;
+  while (!ready_.empty() && uploaded < max_uploads &&
+         std::chrono::duration<double, std::milli>(Clock::now() - start).count() < budget_ms) {
+    Decoded decoded = std::move(ready_.front());
+    ready_.pop_front();
+    const auto iter = entries_.find(decoded.key);
+    if (iter == entries_.end() || iter->second.status != Status::kPending) {
+      SDL_FreeSurface(decoded.surface);
+      continue;
+    }
+    Entry &entry = iter->second;
+    stats_.decode_ms_total += decoded.decode_ms;
+    stats_.decode_ms_max = std::max(stats_.decode_ms_max, decoded.decode_ms);
+    if (!decoded.surface) {
+      entry.status = Status::kFailed;
+      ++stats_.failed;
+      continue;
+    }
+    const auto upload_start = Clock::now();
+    entry.texture = SDL_CreateTextureFromSurface(renderer_, decoded.surface);
+    SDL_FreeSurface(decoded.surface);
+    const auto now = Clock::now();
+    if (!entry.texture) {
+      entry.status = Status::kFailed;
+      ++stats_.failed;
+      continue;
+    }
+    SDL_SetTextureBlendMode(entry.texture, SDL_BLENDMODE_BLEND);
+    entry.status = Status::kReady;
+    const double upload_ms = std::chrono::duration<double, std::milli>(now - upload_start).count();
+    const double ready_ms =
+        std::chrono::duration<double, std::milli>(now - entry.requested).count();
+    ++stats_.uploaded;
+    stats_.upload_ms_total += upload_ms;
+    stats_.upload_ms_max = std::max(stats_.upload_ms_max, upload_ms);
+    stats_.ready_ms_total += ready_ms;
+    stats_.ready_ms_max = std::max(stats_.ready_ms_max, ready_ms);
+    ++uploaded;
+  }
+  if (uploaded > 0) {
+    ++generation_;
+  }
+  return uploaded;
+}
+
+void ImagePipeline::HandleDeviceReset() {
+  for (auto &[key, entry] : entries_) {
+    if (entry.texture) {
+      SDL_DestroyTexture(entry.texture);
+      entry.texture = nullptr;
+    }
+    if (entry.status == Status::kReady) {
+      entry.status = Status::kPending;
+      entry.requested = Clock::now();
+      Enqueue(entry.request);
+    }
+  }
+}
+
+SDL_Surface *ImagePipeline::Load(const Request &request, std::string &store_pixels,
+                                 ThumbnailCache::Source &origin) const {
+  const bool sized = request.width > 0 && request.height > 0;
+  if (sized && thumbnails_) {
+    ProfileScope scope(profiler_, "images", "cache_load");
+    SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, request.width, request.height, 32,
+                                                          SDL_PIXELFORMAT_ARGB8888);
+    if (surface && thumbnails_->Load(request.path, request.width, request.height,
+                                     surface->pixels, static_cast<size_t>(surface->pitch))) {
+      return surface;
+    }
+    SDL_FreeSurface(surface);
+  }
+
+  ProfileScope scope(profiler_, "images", "decode");
+  // The thumbnail records the identity of exactly the bytes decoded here; the
+  // mtime is read first so a replacement racing the map is seen as a change.
+  const int64_t mtime = ThumbnailCache::SourceMtime(request.path);
+  const data::MappedFile file = data::MappedFile::Open(request.path);
+  if (!file.is_open()) {
+    return nullptr;
+  }
+  SDL_Surface *surface = DecodeImage(file.view());
+  if (surface && sized) {
+    surface = ScaleImage(surface, request.width, request.height);
+  }
+  if (surface && sized && thumbnails_) {
+    origin = {file.view().size(), mtime, data::HashBytes(file.view())};
+    // Copied out now because the surface belongs to the render thread once
+    // it is handed over.
+    const size_t row_bytes = static_cast<size_t>(surface->w) * 4;
+    store_pixels.resize(row_bytes * static_cast<size_t>(surface->h));
+    for (int y = 0; y < surface->h; ++y) {
+      std::memcpy(store_pixels.data() + static_cast<size_t>(y) * row_bytes,
+                  static_cast<const char *>(surface->pixels) +
+                      static_cast<size_t>(y) * static_cast<size_t>(surface->pitch),
+                  row_bytes);
+    }
+  }
+  return surface;
+}
+
+void ImagePipeline::Run() {
+  while (true) {
+    Request request;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      wake_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+      if (stopping_) {
+        return;
+      }
+      request = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    Decoded decoded;
+    decoded.key = request.key;
+    std::string store_pixels;
+    ThumbnailCache::Source origin;
+    const auto start = Clock::now();
+    decoded.surface = Load(request, store_pixels, origin);
+    decoded.decode_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      decoded_.push_back(std::move(decoded));
+    }
+    if (on_decoded_) {
+      on_decoded_();
+    }
+    if (!store_pixels.empty()) {
+      ProfileScope scope(profiler_, "images", "cache_store");
+      thumbnails_->Store(request.path, origin, request.width, request.height, store_pixels);
+    }
+  }
+}
+
+}  // namespace vita::ui
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <SDL.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "ui/profiler.h"
+#include "ui/thumbnail_cache.h"
+
+namespace vita::ui {
+
+// Loads artwork without stalling frames. Get() is called while drawing and
+// queues a decode the first time it sees a path; a pool of worker threads
+// decodes files into ARGB8888 surfaces (PNG and JPEG through SDL_image when
+// the build has it, BMP otherwise). Upload() runs once per frame on the
+// render thread and turns a bounded number of decoded surfaces into
+// textures, so a page full of new icons is spread over several frames
+// instead of landing in one. Until then callers draw a placeholder and
+// repaint when generation() moves. Images requested at a fixed size are
+// scaled on the worker and, given a ThumbnailCache, read from it instead of
+// being decoded; misses are written back by the worker after the decoded
+// image has been handed over.
+class ImagePipeline {
+ public:
+  static constexpr int kUploadsPerFrame = 4;
+  static constexpr double kUploadBudgetMs = 2.0;
+
+  struct Stats {
+    uint64_t requested = 0;
+    uint64_t uploaded = 0;
+    uint64_t failed = 0;
+    double decode_ms_total = 0.0;
+    double decode_ms_max = 0.0;
+    double upload_ms_total = 0.0;
+    double upload_ms_max = 0.0;
+    // From the first Get() to the texture being ready.
+    double ready_ms_total = 0.0;
+    double ready_ms_max = 0.0;
+  };
+
+  // `on_decoded` runs on a worker after each decode, so a sleeping main loop
+  // can be woken to upload it. Zero workers picks a count from the CPU.
+  explicit ImagePipeline(SDL_Renderer *renderer, size_t workers = 0,
+                         std::function<void()> on_decoded = {}, Profiler *profiler = nullptr,
+                         ThumbnailCache *thumbnails = nullptr);
+  ~ImagePipeline();
+
+  ImagePipeline(const ImagePipeline &) = delete;
+  ImagePipeline &operator=(const ImagePipeline &) = delete;
+
+  // The texture for `path` once it is uploaded, otherwise nullptr (also for
+  // empty paths and files that failed to decode). A non-zero size scales
+  // the image to width x height; each size is a separate texture.
+  SDL_Texture *Get(const std::string &path, int width = 0, int height = 0);
+  // Like Get() but never queues a decode.
+  SDL_Texture *Find(const std::string &path, int width = 0, int height = 0) const;
+  // Destroys the texture (or drops the pending decode) so a later Get()
+  // loads the image again.
+  void Release(const std::string &path, int width = 0, int height = 0);
+  // Uploads at most `max_uploads` decoded images, stopping early once
+  // `budget_ms` has been spent. Returns how many textures were created.
+  int Upload(int max_uploads = kUploadsPerFrame, double budget_ms = kUploadBudgetMs);
+  // True while decoded images are waiting for Upload().
+  bool has_pending_uploads() const;
+  // Bumped whenever Upload() creates textures.
+  uint64_t generation() const { return generation_; }
+  // Call on SDL_RENDER_DEVICE_RESET; every image is decoded again.
+  void HandleDeviceReset();
+  const Stats &stats() const { return stats_; }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  enum class Status { kPending, kReady, kFailed };
+
+  struct Request {
+    std::string key;
+    std::string path;
+    int width = 0;
+    int height = 0;
+  };
+
+  struct Entry {
+    Request request;
+    Status status = Status::kPending;
+    SDL_Texture *texture = nullptr;
+    Clock::time_point requested;
+  };
+
+  struct Decoded {
+    std::string key;
+    SDL_Surface *surface = nullptr;  // null when decoding failed
+    double decode_ms = 0.0;
+  };
+
+  void Run();
+  static std::string Key(const std::string &path, int width, int height);
+  void Enqueue(Request request);
+  // Reads the thumbnail or decodes the source. After a decode worth caching,
+  // fills `store_pixels` and `origin` for ThumbnailCache::Store.
+  SDL_Surface *Load(const Request &request, std::string &store_pixels,
+                    ThumbnailCache::Source &origin) const;
+
+  SDL_Renderer *renderer_;
+  std::function<void()> on_decoded_;
+  Profiler *profiler_;
+  ThumbnailCache *thumbnails_;
+
+  // Render-thread state.
+  std::unordered_map<std::string, Entry> entries_;  // by Request::key
+  std::deque<Decoded> ready_;
+  uint64_t generation_ = 0;
+  Stats stats_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable wake_;
+  std::deque<Request> queue_;
+  std::vector<Decoded> decoded_;
+  bool stopping_ = false;
+
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace vita::ui
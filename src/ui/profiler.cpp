@@ -0,0 +1,125 @@
+#include "ui/profiler.h"
+
+#include <algorithm>
+
+#include "data/file_util.h"
+#include "data/json.h"
+
+namespace vita::ui {
+namespace {
+
+uint32_t CurrentThreadTag() {
+  static std::atomic<uint32_t> next_tag{1};
+  thread_local const uint32_t tag = next_tag++;
+  return tag;
+}
+
+}  // namespace
+
+Profiler::Profiler() : epoch_(std::chrono::steady_clock::now()), slots_(kCapacity) {}
+
+void Profiler::Record(const char *name, const char *category,
+                      std::chrono::steady_clock::time_point start,
+                      std::chrono::steady_clock::time_point end) {
+  using std::chrono::duration_cast;
+  using std::chrono::nanoseconds;
+  const uint64_t index = head_.fetch_add(1, std::memory_order_relaxed);
+  Slot &slot = slots_[index % kCapacity];
+  slot.sequence.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.name.store(name, std::memory_order_relaxed);
+  slot.category.store(category, std::memory_order_relaxed);
+  slot.start_ns.store(static_cast<uint64_t>(duration_cast<nanoseconds>(start - epoch_).count()),
+                      std::memory_order_relaxed);
+  slot.duration_ns.store(static_cast<uint64_t>(duration_cast<nanoseconds>(end - start).count()),
+                         std::memory_order_relaxed);
+  slot.thread.store(CurrentThreadTag(), std::memory_order_relaxed);
+  slot.sequence.store(index + 1, std::memory_order_release);
+}
+
+bool Profiler::Read(uint64_t index, Record_ &record) const {
+  const Slot &slot = slots_[index % kCapacity];
+  if (slot.sequence.load(std::memory_order_acquire) != index + 1) {
+    return false;
+  }
+  record.name = slot.name.load(std::memory_order_relaxed);
+  record.category = slot.category.load(std::memory_order_relaxed);
+  record.start_ns = slot.start_ns.load(std::memory_order_relaxed);
+  record.duration_ns = slot.duration_ns.load(std::memory_order_relaxed);
+  record.thread = slot.thread.load(std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return slot.sequence.load(std::memory_order_relaxed) == index + 1;
+}
+
+void Profiler::Collect() {
+  const uint64_t head = head_.load(std::memory_order_acquire);
+  uint64_t index = std::max(collected_, head > kCapacity ? head - kCapacity : 0);
+  for (; index < head; ++index) {
+    Record_ record;
+    if (!Read(index, record)) {
+      continue;  // still being written, or already overwritten
+    }
+    Series &series = series_[{record.name, record.category}];
+    series.micros[series.next] = static_cast<uint32_t>(
+        std::min<uint64_t>(record.duration_ns / 1000, UINT32_MAX));
+    series.next = (series.next + 1) % kWindow;
+    series.count = std::min(series.count + 1, kWindow);
+  }
+  collected_ = head;
+}
+
+std::vector<Profiler::Summary> Profiler::Summaries() const {
+  std::vector<Summary> summaries;
+  std::vector<uint32_t> sorted;
+  for (const auto &[key, series] : series_) {
+    sorted.assign(series.micros.begin(), series.micros.begin() + series.count);
+    std::sort(sorted.begin(), sorted.end());
+    Summary summary;
+    summary.name = key.first;
+    summary.category = key.second;
+    summary.samples = sorted.size();
+    if (!sorted.empty()) {
+      summary.p50_ms = sorted[(sorted.size() - 1) / 2] / 1000.0;
+      summary.p99_ms = sorted[(sorted.size() - 1) * 99 / 100] / 1000.0;
+    }
+    summaries.push_back(summary);
+  }
+  return summaries;
+}
+
+bool Profiler::ExportChromeTrace(const std::filesystem::path &path) const {
+  const uint64_t head = head_.load(std::memory_order_acquire);
+  data::JsonWriter writer;
+  writer.BeginObject();
+  writer.WriteKey("traceEvents");
+  writer.BeginArray();
+  for (uint64_t index = head > kCapacity ? head - kCapacity : 0; index < head; ++index) {
+    Record_ record;
+    if (!Read(index, record)) {
+      continue;
+    }
+    writer.BeginObject();
+    writer.WriteKey("name");
+    writer.WriteString(record.name);
+    writer.WriteKey("cat");
+    writer.WriteString(record.category);
+    writer.WriteKey("ph");
+    writer.WriteString("X");
+    writer.WriteKey("ts");
+    writer.WriteNumber(static_cast<double>(record.start_ns) / 1000.0);
+    writer.WriteKey("dur");
+    writer.WriteNumber(static_cast<double>(record.duration_ns) / 1000.0);
+    writer.WriteKey("pid");
+    writer.WriteNumber(1);
+    writer.WriteKey("tid");
+    writer.WriteNumber(record.thread);
+    writer.EndObject();
+  }
+  writer.EndArray();
+  writer.WriteKey("displayTimeUnit");
+  writer.WriteString("ms");
+  writer.EndObject();
+  return data::WriteFileAtomic(path, writer.view());
+}
+
+}  // namespace vita::ui
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace vita::ui {
+
+// Collects scoped timings from any thread into a fixed ring buffer without
+// locking: writers claim a slot with one atomic increment and publish it
+// with a per-slot sequence number, so readers can tell when a slot was
+// overwritten under them. Names and categories must be string literals or
+// otherwise outlive the profiler.
+//
+// Collect() (main thread) folds records published since the last call into
+// rolling per-(name, category) windows for the HUD; ExportChromeTrace()
+// writes whatever the ring still holds in Chrome's trace event format.
+class Profiler {
+ public:
+  static constexpr size_t kCapacity = 1 << 15;
+  static constexpr size_t kWindow = 240;
+
+  struct Summary {
+    std::string_view name;
+    std::string_view category;
+    double p50_ms = 0.0;
+    double p99_ms = 0.0;
+    size_t samples = 0;
+  };
+
+  Profiler();
+
+  Profiler(const Profiler &) = delete;
+  Profiler &operator=(const Profiler &) = delete;
+
+  void Record(const char *name, const char *category, std::chrono::steady_clock::time_point start,
+              std::chrono::steady_clock::time_point end);
+
+  void Collect();
+  std::vector<Summary> Summaries() const;
+  bool ExportChromeTrace(const std::filesystem::path &path) const;
+
+ private:
+  struct Slot {
+    std::atomic<uint64_t> sequence{0};  // claimed index + 1 once written
+    std::atomic<const char *> name{nullptr};
+    std::atomic<const char *> category{nullptr};
+    std::atomic<uint64_t> start_ns{0};
+    std::atomic<uint64_t> duration_ns{0};
+    std::atomic<uint32_t> thread{0};
+  };
+
+  struct Record_ {
+    const char *name;
+    const char *category;
+    uint64_t start_ns;
+    uint64_t duration_ns;
+    uint32_t thread;
+  };
+
+  struct Series {
+    std::array<uint32_t, kWindow> micros{};
+    size_t count = 0;
+    size_t next = 0;
+  };
+
+  std::chrono::steady_clock::time_point epoch_;
+  std::vector<Slot> slots_;
+  std::atomic<uint64_t> head_{0};
+  uint64_t collected_ = 0;
+  std::map<std::pair<std::string_view, std::string_view>, Series> series_;
+
+  bool Read(uint64_t index, Record_ &record) const;
+};
+
+// Times the enclosing block; a null profiler makes it a no-op.
+class ProfileScope {
+ public:
+  ProfileScope(Profiler *profiler, const char *name, const char *category)
+      : profiler_(profiler),
+        name_(name),
+        category_(category),
+        start_(profiler ? std::chrono::steady_clock::now()
+                        : std::chrono::steady_clock::time_point()) {}
+  ~ProfileScope() {
+    if (profiler_) {
+      profiler_->Record(name_, category_, start_, std::chrono::steady_clock::now());
+    }
+  }
+
+  ProfileScope(const ProfileScope &) = delete;
+  ProfileScope &operator=(const ProfileScope &) = delete;
+
+ private:
+  Profiler *profiler_;
+  const char *name_;
+  const char *category_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace vita::ui
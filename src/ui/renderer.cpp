@@ -1,43 +1,245 @@
 #include "ui/renderer.h"
 
+#include <algorithm>
+#include <optional>
+
 namespace vita::ui {
 
-Renderer::Renderer(SDL_Renderer *renderer) : renderer_(renderer) {}
+Renderer::Renderer(SDL_Renderer *renderer) : renderer_(renderer), atlas_(renderer) {}
 
-void Renderer::Clear(const SDL_Color &color) const {
-  SDL_SetRenderDrawBlendMode(renderer_, SDL_BLENDMODE_BLEND);
-  SDL_SetRenderDrawColor(renderer_, color.r, color.g, color.b, color.a);
-  SDL_RenderClear(renderer_);
+void Renderer::BeginFrame() {
+  stats_ = RenderStats{};
+  blend_known_ = false;
+  color_known_ = false;
 }
 
-void Renderer::DrawRect(int x, int y, int w, int h, const SDL_Color &color) const {
-  SDL_Rect rect{x, y, w, h};
-  SDL_SetRenderDrawBlendMode(renderer_, SDL_BLENDMODE_BLEND);
-  SDL_SetRenderDrawColor(renderer_, color.r, color.g, color.b, color.a);
-  SDL_RenderFillRect(renderer_, &rect);
+void Renderer::EndFrame() {
+  Flush();
+  last_stats_ = stats_;
 }
 
-void Renderer::DrawRectOutline(int x, int y, int w, int h, const SDL_Color &color, int thickness) const {
-  SDL_SetRenderDrawBlendMode(renderer_, SDL_BLENDMODE_BLEND);
-  SDL_SetRenderDrawColor(renderer_, color.r, color.g, color.b, color.a);
-  for (int i = 0; i < thickness; ++i) {
-    SDL_Rect rect{x + i, y + i, w - (i * 2), h - (i * 2)};
-    SDL_RenderDrawRect(renderer_, &rect);
+void Renderer::HandleDeviceReset() {
+  quads_.clear();
+  blend_known_ = false;
+  color_known_ = false;
+  atlas_.HandleDeviceReset();
+}
+
+void Renderer::SetClip(const SDL_Rect *clip) {
+  if (!clip && !clipped_) {
+    return;
   }
+  Flush();
+  clipped_ = clip != nullptr;
+  if (clip) {
+    clip_ = *clip;
+  }
+  SDL_RenderSetClipRect(renderer_, clip);
+  ++stats_.state_changes;
 }
 
-void Renderer::DrawCircle(int cx, int cy, int radius, const SDL_Color &color) const {
-  SDL_SetRenderDrawBlendMode(renderer_, SDL_BLENDMODE_BLEND);
-  SDL_SetRenderDrawColor(renderer_, color.r, color.g, color.b, color.a);
-  for (int w = 0; w < radius * 2; ++w) {
-    for (int h = 0; h < radius * 2; ++h) {
-      const int dx = radius - w;
-      const int dy = radius - h;
-      if ((dx * dx + dy * dy) <= (radius * radius)) {
-        SDL_RenderDrawPoint(renderer_, cx + dx, cy + dy);
+void Renderer::Flush() {
+  if (quads_.empty()) {
+    return;
+  }
+  SetBlendMode(SDL_BLENDMODE_BLEND);
+  SDL_Texture *texture = atlas_.Texture();
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+  SubmitGeometry(texture);
+#else
+  SubmitRuns(texture);
+#endif
+  quads_.clear();
+}
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+void Renderer::SubmitGeometry(SDL_Texture *texture) {
+  constexpr float kScale = 1.0f / static_cast<float>(ShapeAtlas::kSize);
+  vertices_.clear();
+  indices_.clear();
+  for (const Quad &quad : quads_) {
+    const float left = static_cast<float>(quad.dst.x);
+    const float top = static_cast<float>(quad.dst.y);
+    const float right = static_cast<float>(quad.dst.x + quad.dst.w);
+    const float bottom = static_cast<float>(quad.dst.y + quad.dst.h);
+    const float u0 = static_cast<float>(quad.src.x) * kScale;
+    const float v0 = static_cast<float>(quad.src.y) * kScale;
+    const float u1 = static_cast<float>(quad.src.x + quad.src.w) * kScale;
+    const float v1 = static_cast<float>(quad.src.y + quad.src.h) * kScale;
+    const int base = static_cast<int>(vertices_.size());
+    vertices_.push_back({{left, top}, quad.color, {u0, v0}});
+    vertices_.push_back({{right, top}, quad.color, {u1, v0}});
+    vertices_.push_back({{right, bottom}, quad.color, {u1, v1}});
+    vertices_.push_back({{left, bottom}, quad.color, {u0, v1}});
+    for (int offset : {0, 1, 2, 0, 2, 3}) {
+      indices_.push_back(base + offset);
+    }
+  }
+  SDL_RenderGeometry(renderer_, texture, vertices_.data(), static_cast<int>(vertices_.size()),
+                     indices_.data(), static_cast<int>(indices_.size()));
+  ++stats_.draw_calls;
+}
+#else
+void Renderer::SubmitRuns(SDL_Texture *texture) {
+  auto same_color = [](const SDL_Color &lhs, const SDL_Color &rhs) {
+    return lhs.r == rhs.r && lhs.g == rhs.g && lhs.b == rhs.b && lhs.a == rhs.a;
+  };
+  for (size_t i = 0; i < quads_.size();) {
+    const Quad &first = quads_[i];
+    if (!first.solid) {
+      if (texture) {
+        SDL_SetTextureColorMod(texture, first.color.r, first.color.g, first.color.b);
+        SDL_SetTextureAlphaMod(texture, first.color.a);
+        SDL_RenderCopy(renderer_, texture, &first.src, &first.dst);
+        stats_.state_changes += 2;
+        ++stats_.draw_calls;
       }
+      ++i;
+      continue;
+    }
+    rects_.clear();
+    for (; i < quads_.size() && quads_[i].solid && same_color(quads_[i].color, first.color); ++i) {
+      rects_.push_back(quads_[i].dst);
+    }
+    SetColor(first.color);
+    SDL_RenderFillRects(renderer_, rects_.data(), static_cast<int>(rects_.size()));
+    ++stats_.draw_calls;
+  }
+}
+#endif
+
+void Renderer::Queue(const SDL_Rect &dst, const SDL_Color &color) {
+  if (dst.w <= 0 || dst.h <= 0) {
+    return;
+  }
+  quads_.push_back({dst, atlas_.Solid(), color, true});
+  ++stats_.primitives;
+}
+
+void Renderer::QueueShape(const SDL_Rect &dst, const SDL_Rect &src, const SDL_Color &color) {
+  if (dst.w <= 0 || dst.h <= 0) {
+    return;
+  }
+  quads_.push_back({dst, src, color, false});
+  ++stats_.primitives;
+}
+
+void Renderer::QueueCorners(const SDL_Rect &rect, const SDL_Rect &shape, const SDL_Color &color) {
+  const int r = shape.w / 2;
+  QueueShape({rect.x, rect.y, r, r}, {shape.x, shape.y, r, r}, color);
+  QueueShape({rect.x + rect.w - r, rect.y, r, r}, {shape.x + r, shape.y, r, r}, color);
+  QueueShape({rect.x, rect.y + rect.h - r, r, r}, {shape.x, shape.y + r, r, r}, color);
+  QueueShape({rect.x + rect.w - r, rect.y + rect.h - r, r, r}, {shape.x + r, shape.y + r, r, r},
+             color);
+}
+
+void Renderer::SetBlendMode(SDL_BlendMode mode) {
+  if (blend_known_ && blend_ == mode) {
+    return;
+  }
+  SDL_SetRenderDrawBlendMode(renderer_, mode);
+  blend_ = mode;
+  blend_known_ = true;
+  ++stats_.state_changes;
+}
+
+void Renderer::SetColor(const SDL_Color &color) {
+  if (color_known_ && color.r == color_.r && color.g == color_.g && color.b == color_.b &&
+      color.a == color_.a) {
+    return;
+  }
+  SDL_SetRenderDrawColor(renderer_, color.r, color.g, color.b, color.a);
+  color_ = color;
+  color_known_ = true;
+  ++stats_.state_changes;
+}
+
+void Renderer::Clear(const SDL_Color &color) {
+  if (clipped_) {
+    // SDL_RenderClear ignores the clip rect; repaint just the clipped area.
+    Queue(clip_, color);
+    return;
+  }
+  // Clearing covers the whole target, so anything still queued is invisible.
+  quads_.clear();
+  SetBlendMode(SDL_BLENDMODE_BLEND);
+  SetColor(color);
+  SDL_RenderClear(renderer_);
+  ++stats_.draw_calls;
+}
+
+void Renderer::DrawRect(int x, int y, int w, int h, const SDL_Color &color) {
+  Queue({x, y, w, h}, color);
+}
+
+void Renderer::DrawRectOutline(int x, int y, int w, int h, const SDL_Color &color, int thickness) {
+  const int band_x = std::min(thickness, (w + 1) / 2);
+  const int band_y = std::min(thickness, (h + 1) / 2);
+  Queue({x, y, w, band_y}, color);
+  Queue({x, y + h - band_y, w, band_y}, color);
+  Queue({x, y + band_y, band_x, h - band_y * 2}, color);
+  Queue({x + w - band_x, y + band_y, band_x, h - band_y * 2}, color);
+}
+
+void Renderer::DrawCircle(int cx, int cy, int radius, const SDL_Color &color) {
+  if (const std::optional<SDL_Rect> disc = atlas_.Disc(radius)) {
+    QueueShape({cx - radius, cy - radius, radius * 2, radius * 2}, *disc, color);
+    return;
+  }
+  // Atlas full: one aliased span per row, covering the offsets (dx, dy) in
+  // (-radius, radius] with dx * dx + dy * dy <= radius^2.
+  const int radius_sq = radius * radius;
+  int half_width = 0;
+  for (int dy = radius; dy > -radius; --dy) {
+    const int remaining = radius_sq - dy * dy;
+    while ((half_width + 1) * (half_width + 1) <= remaining) {
+      ++half_width;
+    }
+    while (half_width * half_width > remaining) {
+      --half_width;
     }
+    const int left = std::max(-half_width, -radius + 1);
+    Queue({cx + left, cy + dy, half_width - left + 1, 1}, color);
+  }
+}
+
+void Renderer::DrawPanel(int x, int y, int w, int h, const SDL_Color &color, int radius) {
+  const int r = std::min({radius, w / 2, h / 2});
+  const std::optional<SDL_Rect> disc = r > 0 ? atlas_.Disc(r) : std::nullopt;
+  if (!disc) {
+    DrawRect(x, y, w, h, color);
+    return;
+  }
+  QueueCorners({x, y, w, h}, *disc, color);
+  Queue({x + r, y, w - r * 2, r}, color);
+  Queue({x, y + r, w, h - r * 2}, color);
+  Queue({x + r, y + h - r, w - r * 2, r}, color);
+}
+
+void Renderer::DrawPanelOutline(int x, int y, int w, int h, const SDL_Color &color, int thickness,
+                                int radius) {
+  const int r = std::min({radius, w / 2, h / 2});
+  const std::optional<SDL_Rect> ring =
+      (r > 0 && thickness <= r) ? atlas_.Ring(r, thickness) : std::nullopt;
+  if (!ring) {
+    DrawRectOutline(x, y, w, h, color, thickness);
+    return;
+  }
+  QueueCorners({x, y, w, h}, *ring, color);
+  Queue({x + r, y, w - r * 2, thickness}, color);
+  Queue({x + r, y + h - thickness, w - r * 2, thickness}, color);
+  Queue({x, y + r, thickness, h - r * 2}, color);
+  Queue({x + w - thickness, y + r, thickness, h - r * 2}, color);
+}
+
+void Renderer::DrawTexture(SDL_Texture *texture, const SDL_Rect &dst) {
+  if (!texture || dst.w <= 0 || dst.h <= 0) {
+    return;
   }
+  Flush();
+  SDL_RenderCopy(renderer_, texture, nullptr, &dst);
+  ++stats_.draw_calls;
+  ++stats_.primitives;
 }
 
 }  // namespace vita::ui
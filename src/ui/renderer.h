@@ -2,19 +2,95 @@
 
 #include <SDL.h>
 
+#include <vector>
+
+#include "ui/shape_atlas.h"
+
 namespace vita::ui {
 
+// Per-frame submission counters. draw_calls counts SDL_Render* calls that
+// reach the driver; state_changes counts draw color / blend mode updates.
+struct RenderStats {
+  int draw_calls = 0;
+  int state_changes = 0;
+  int primitives = 0;
+};
+
+// Queues every primitive as a quad sampling the shape atlas (solid fills use
+// its white block) and submits the queue in one SDL_RenderGeometry call with
+// per-vertex colors where SDL is new enough. Older SDL gets one
+// SDL_RenderFillRects per run of equal solid colors and an SDL_RenderCopy per
+// shaped quad. Flush() before switching render targets or touching the SDL
+// renderer directly.
 class Renderer {
  public:
+  // `renderer` must outlive this object: the atlas texture is destroyed
+  // with it.
   explicit Renderer(SDL_Renderer *renderer);
 
-  void Clear(const SDL_Color &color) const;
-  void DrawRect(int x, int y, int w, int h, const SDL_Color &color) const;
-  void DrawCircle(int cx, int cy, int radius, const SDL_Color &color) const;
-  void DrawRectOutline(int x, int y, int w, int h, const SDL_Color &color, int thickness = 1) const;
+  void BeginFrame();
+  // Flushes and publishes this frame's counters to stats().
+  void EndFrame();
+  void Flush();
+  // Call on SDL_RENDER_DEVICE_RESET; textures are rebuilt on next use.
+  void HandleDeviceReset();
+  // Restricts drawing to `clip` (nullptr lifts it); flushes queued quads.
+  void SetClip(const SDL_Rect *clip);
+  const RenderStats &stats() const { return last_stats_; }
+  const ShapeAtlas &atlas() const { return atlas_; }
+
+  void Clear(const SDL_Color &color);
+  void DrawRect(int x, int y, int w, int h, const SDL_Color &color);
+  void DrawCircle(int cx, int cy, int radius, const SDL_Color &color);
+  void DrawRectOutline(int x, int y, int w, int h, const SDL_Color &color, int thickness = 1);
+  // Anti-aliased rounded shapes; corners come from atlas disc and ring masks.
+  void DrawPanel(int x, int y, int w, int h, const SDL_Color &color, int radius);
+  void DrawPanelOutline(int x, int y, int w, int h, const SDL_Color &color, int thickness,
+                        int radius);
+  // Copies a whole texture into `dst`. Flushes queued quads first so the
+  // draw order is kept, which ends the current batch.
+  void DrawTexture(SDL_Texture *texture, const SDL_Rect &dst);
 
  private:
+  struct Quad {
+    SDL_Rect dst;
+    SDL_Rect src;
+    SDL_Color color;
+    bool solid;
+  };
+
   SDL_Renderer *renderer_;
+  ShapeAtlas atlas_;
+  std::vector<Quad> quads_;
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+  std::vector<SDL_Vertex> vertices_;
+  std::vector<int> indices_;
+#else
+  std::vector<SDL_Rect> rects_;
+#endif
+
+  // Last state sent to SDL, so redundant updates are skipped.
+  bool blend_known_ = false;
+  bool color_known_ = false;
+  SDL_BlendMode blend_ = SDL_BLENDMODE_NONE;
+  SDL_Color color_{0, 0, 0, 0};
+  bool clipped_ = false;
+  SDL_Rect clip_{0, 0, 0, 0};
+
+  RenderStats stats_;
+  RenderStats last_stats_;
+
+  void Queue(const SDL_Rect &dst, const SDL_Color &color);
+  void QueueShape(const SDL_Rect &dst, const SDL_Rect &src, const SDL_Color &color);
+  // Draws the four w x h quadrants of `shape` at the corners of `rect`.
+  void QueueCorners(const SDL_Rect &rect, const SDL_Rect &shape, const SDL_Color &color);
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+  void SubmitGeometry(SDL_Texture *texture);
+#else
+  void SubmitRuns(SDL_Texture *texture);
+#endif
+  void SetBlendMode(SDL_BlendMode mode);
+  void SetColor(const SDL_Color &color);
 };
 
 }  // namespace vita::ui
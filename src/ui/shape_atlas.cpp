@@ -0,0 +1,129 @@
+#include "ui/shape_atlas.h"
+
+#include <algorithm>
+
+namespace vita::ui {
+namespace {
+
+constexpr int kSolidSize = 4;
+constexpr int kPadding = 1;
+constexpr int kSamples = 4;
+
+}  // namespace
+
+ShapeAtlas::ShapeAtlas(SDL_Renderer *renderer)
+    : renderer_(renderer), pixels_(static_cast<size_t>(kSize) * kSize * 4, 0) {
+  // The solid block sits at the origin; its inner texels are never next to
+  // anything but white, so linear filtering cannot pull in transparency.
+  for (int y = 0; y < kSolidSize; ++y) {
+    for (int x = 0; x < kSolidSize; ++x) {
+      std::fill_n(&pixels_[(static_cast<size_t>(y) * kSize + x) * 4], 4, 255);
+    }
+  }
+  shelf_x_ = kSolidSize + kPadding;
+  shelf_height_ = kSolidSize;
+}
+
+ShapeAtlas::~ShapeAtlas() {
+  if (texture_) {
+    SDL_DestroyTexture(texture_);
+  }
+}
+
+SDL_Rect ShapeAtlas::Solid() const { return {1, 1, kSolidSize - 2, kSolidSize - 2}; }
+
+std::optional<SDL_Rect> ShapeAtlas::Disc(int radius) { return Circle(radius, 0); }
+
+std::optional<SDL_Rect> ShapeAtlas::Ring(int radius, int thickness) {
+  return Circle(radius, std::clamp(thickness, 1, radius));
+}
+
+std::optional<SDL_Rect> ShapeAtlas::Allocate(int w, int h) {
+  if (w + kPadding > kSize || h + kPadding > kSize) {
+    return std::nullopt;
+  }
+  if (shelf_x_ + w > kSize) {
+    shelf_y_ += shelf_height_ + kPadding;
+    shelf_x_ = 0;
+    shelf_height_ = 0;
+  }
+  if (shelf_y_ + h > kSize) {
+    return std::nullopt;
+  }
+  const SDL_Rect rect{shelf_x_, shelf_y_, w, h};
+  shelf_x_ += w + kPadding;
+  shelf_height_ = std::max(shelf_height_, h);
+  return rect;
+}
+
+std::optional<SDL_Rect> ShapeAtlas::Circle(int radius, int thickness) {
+  if (radius <= 0) {
+    return std::nullopt;
+  }
+  const uint64_t key = (static_cast<uint64_t>(radius) << 32) | static_cast<uint32_t>(thickness);
+  if (const auto iter = regions_.find(key); iter != regions_.end()) {
+    return iter->second;
+  }
+  const std::optional<SDL_Rect> rect = Allocate(radius * 2, radius * 2);
+  if (!rect) {
+    return std::nullopt;
+  }
+  // Coverage from a kSamples x kSamples grid per pixel against the circle
+  // (and, for rings, the inner circle) centered on the box.
+  const float outer_sq = static_cast<float>(radius * radius);
+  const float inner = static_cast<float>(radius - thickness);
+  const float inner_sq = thickness > 0 ? inner * inner : -1.0f;
+  for (int y = 0; y < rect->h; ++y) {
+    for (int x = 0; x < rect->w; ++x) {
+      int covered = 0;
+      for (int sy = 0; sy < kSamples; ++sy) {
+        for (int sx = 0; sx < kSamples; ++sx) {
+          const float dx = static_cast<float>(x) + (sx + 0.5f) / kSamples - radius;
+          const float dy = static_cast<float>(y) + (sy + 0.5f) / kSamples - radius;
+          const float distance_sq = dx * dx + dy * dy;
+          if (distance_sq <= outer_sq && distance_sq >= inner_sq) {
+            ++covered;
+          }
+        }
+      }
+      uint8_t *pixel = &pixels_[(static_cast<size_t>(rect->y + y) * kSize + rect->x + x) * 4];
+      pixel[0] = pixel[1] = pixel[2] = 255;
+      pixel[3] = static_cast<uint8_t>(covered * 255 / (kSamples * kSamples));
+    }
+  }
+  regions_.emplace(key, *rect);
+  dirty_ = true;
+  return rect;
+}
+
+SDL_Texture *ShapeAtlas::Texture() {
+  if (!texture_) {
+    texture_ = SDL_CreateTexture(renderer_, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC,
+                                 kSize, kSize);
+    if (!texture_) {
+      return nullptr;
+    }
+    SDL_SetTextureBlendMode(texture_, SDL_BLENDMODE_BLEND);
+    dirty_ = true;
+  }
+  if (dirty_) {
+    SDL_UpdateTexture(texture_, nullptr, pixels_.data(), kSize * 4);
+    dirty_ = false;
+  }
+  return texture_;
+}
+
+void ShapeAtlas::HandleDeviceReset() {
+  if (texture_) {
+    SDL_DestroyTexture(texture_);
+    texture_ = nullptr;
+  }
+  dirty_ = true;
+}
+
+size_t ShapeAtlas::memory_bytes() const {
+  const size_t texture_bytes = texture_ ? static_cast<size_t>(kSize) * kSize * 4 : 0;
+  return pixels_.capacity() + texture_bytes;
+}
+
+}  // namespace vita::ui
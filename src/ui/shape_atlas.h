@@ -0,0 +1,60 @@
+#pragma once
+
+#include <SDL.h>
+
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace vita::ui {
+
+// One texture holding anti-aliased coverage masks (white, alpha = coverage)
+// for the shapes the renderer draws: a solid block, discs and rings, keyed by
+// size. Color comes from vertex or texture modulation at draw time, so one
+// entry serves every color. Masks are packed on shelves into a CPU copy that
+// is uploaded on demand, which is also what lets the texture be recreated
+// after the renderer loses its device.
+class ShapeAtlas {
+ public:
+  static constexpr int kSize = 512;
+
+  explicit ShapeAtlas(SDL_Renderer *renderer);
+  // Destroys the texture, so it must run before SDL_DestroyRenderer.
+  ~ShapeAtlas();
+
+  ShapeAtlas(const ShapeAtlas &) = delete;
+  ShapeAtlas &operator=(const ShapeAtlas &) = delete;
+
+  // Opaque region safe to stretch over any rect.
+  SDL_Rect Solid() const;
+  // A filled circle of the given radius in a 2r x 2r box, or nullopt when the
+  // atlas is full. Quadrants of the box serve as rounded corners.
+  std::optional<SDL_Rect> Disc(int radius);
+  // A circle outline `thickness` pixels wide, inside the same box.
+  std::optional<SDL_Rect> Ring(int radius, int thickness);
+
+  // Uploads new masks and returns the texture, creating it if needed.
+  SDL_Texture *Texture();
+  // Forgets the texture after SDL_RENDER_DEVICE_RESET; the next Texture()
+  // call rebuilds it from the CPU copy.
+  void HandleDeviceReset();
+
+  size_t memory_bytes() const;
+  size_t entry_count() const { return regions_.size(); }
+
+ private:
+  SDL_Renderer *renderer_;
+  SDL_Texture *texture_ = nullptr;
+  std::vector<uint8_t> pixels_;  // RGBA, kSize x kSize
+  std::unordered_map<uint64_t, SDL_Rect> regions_;
+  bool dirty_ = true;
+  int shelf_x_ = 0;
+  int shelf_y_ = 0;
+  int shelf_height_ = 0;
+
+  std::optional<SDL_Rect> Allocate(int w, int h);
+  std::optional<SDL_Rect> Circle(int radius, int thickness);
+};
+
+}  // namespace vita::ui
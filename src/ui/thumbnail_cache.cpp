@@ -0,0 +1,188 @@
+#include "ui/thumbnail_cache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "data/file_util.h"
+#include "data/mapped_file.h"
+
+namespace vita::ui {
+
+namespace {
+
+constexpr char kMagic[8] = {'V', 'I', 'T', 'A', 'T', 'H', 'M', '\0'};
+constexpr uint32_t kVersion = 1;
+constexpr char kExtension[] = ".thumb";
+
+struct ThumbnailHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t width;
+  uint32_t height;
+  uint32_t reserved;
+  uint64_t source_size;
+  int64_t source_mtime;
+  uint64_t source_hash;
+};
+
+static_assert(sizeof(ThumbnailHeader) == 48, "thumbnail header layout changed");
+
+}  // namespace
+
+int64_t ThumbnailCache::SourceMtime(const std::filesystem::path &path) {
+  std::error_code error;
+  const auto mtime = std::filesystem::last_write_time(path, error);
+  return error ? 0 : static_cast<int64_t>(mtime.time_since_epoch().count());
+}
+
+ThumbnailCache::ThumbnailCache(std::filesystem::path directory, uintmax_t capacity_bytes)
+    : directory_(std::move(directory)), capacity_(capacity_bytes) {
+  std::error_code error;
+  std::filesystem::create_directories(directory_, error);
+  // Rebuild the LRU order from file mtimes, oldest first.
+  std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::directory_entry>> files;
+  for (const auto &entry : std::filesystem::directory_iterator(directory_, error)) {
+    if (entry.is_regular_file(error) && entry.path().extension() == kExtension) {
+      files.emplace_back(entry.last_write_time(error), entry);
+    }
+  }
+  std::sort(files.begin(), files.end(),
+            [](const auto &lhs, const auto &rhs) { return lhs.first < rhs.first; });
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto &[mtime, entry] : files) {
+    Entry &cached = entries_[entry.path().filename().string()];
+    cached.bytes = entry.file_size(error);
+    cached.last_used = ++use_clock_;
+    stats_.bytes += cached.bytes;
+  }
+  EvictLocked({});
+}
+
+std::string ThumbnailCache::FileName(const std::filesystem::path &source, int width,
+                                     int height) const {
+  const std::string key =
+      source.generic_string() + "@" + std::to_string(width) + "x" + std::to_string(height);
+  char name[32];
+  std::snprintf(name, sizeof(name), "%016llx",
+                static_cast<unsigned long long>(data::HashBytes(key)));
+  return std::string(name) + kExtension;
+}
+
+bool ThumbnailCache::Load(const std::filesystem::path &source, int width, int height,
+                          void *pixels, size_t pitch) {
+  const std::string name = FileName(source, width, height);
+  const std::filesystem::path path = directory_ / name;
+  const size_t row_bytes = static_cast<size_t>(width) * 4;
+  const size_t pixel_bytes = row_bytes * static_cast<size_t>(height);
+
+  const data::MappedFile file = data::MappedFile::Open(path);
+  const std::string_view contents = file.view();
+  ThumbnailHeader header{};
+  bool valid = file.is_open() && contents.size() == sizeof(header) + pixel_bytes;
+  if (valid) {
+    std::memcpy(&header, contents.data(), sizeof(header));
+    valid = std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0 &&
+            header.version == kVersion && header.width == static_cast<uint32_t>(width) &&
+            header.height == static_cast<uint32_t>(height);
+  }
+  std::error_code error;
+  if (valid) {
+    const uintmax_t source_size = std::filesystem::file_size(source, error);
+    const int64_t source_mtime = SourceMtime(source);
+    if (error || source_size != header.source_size) {
+      valid = false;
+    } else if (source_mtime != header.source_mtime) {
+      // Touched or copied but maybe not changed: compare contents.
+      const data::MappedFile source_file = data::MappedFile::Open(source);
+      valid = source_file.is_open() && data::HashBytes(source_file.view()) == header.source_hash;
+      if (valid) {
+        header.source_mtime = source_mtime;
+        std::string updated(contents);
+        std::memcpy(updated.data(), &header, sizeof(header));
+        data::WriteFileAtomic(path, updated);
+      }
+    }
+  }
+  if (!valid) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.misses;
+    return false;
+  }
+
+  const char *rows = contents.data() + sizeof(header);
+  for (int y = 0; y < height; ++y) {
+    std::memcpy(static_cast<char *>(pixels) + static_cast<size_t>(y) * pitch,
+                rows + static_cast<size_t>(y) * row_bytes, row_bytes);
+  }
+  std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), error);
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++stats_.hits;
+  Touch(name, contents.size());
+  return true;
+}
+
+bool ThumbnailCache::Store(const std::filesystem::path &source, const Source &origin, int width,
+                           int height, std::string_view pixels) {
+  const size_t pixel_bytes = static_cast<size_t>(width) * static_cast<size_t>(height) * 4;
+  if (width <= 0 || height <= 0 || pixels.size() != pixel_bytes) {
+    return false;
+  }
+  ThumbnailHeader header{};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.width = static_cast<uint32_t>(width);
+  header.height = static_cast<uint32_t>(height);
+  header.source_size = origin.size;
+  header.source_mtime = origin.mtime;
+  header.source_hash = origin.hash;
+
+  std::string contents(sizeof(header), '\0');
+  std::memcpy(contents.data(), &header, sizeof(header));
+  contents.append(pixels);
+  const std::string name = FileName(source, width, height);
+  if (!data::WriteFileAtomic(directory_ / name, contents)) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++stats_.stores;
+  Touch(name, contents.size());
+  EvictLocked(name);
+  return true;
+}
+
+ThumbnailCache::Stats ThumbnailCache::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Stats stats = stats_;
+  stats.entries = entries_.size();
+  return stats;
+}
+
+void ThumbnailCache::Touch(const std::string &name, uintmax_t bytes) {
+  Entry &entry = entries_[name];
+  stats_.bytes = stats_.bytes - entry.bytes + bytes;
+  entry.bytes = bytes;
+  entry.last_used = ++use_clock_;
+}
+
+void ThumbnailCache::EvictLocked(const std::string &keep) {
+  while (stats_.bytes > capacity_ && entries_.size() > (keep.empty() ? 0 : 1)) {
+    auto oldest = entries_.end();
+    for (auto iter = entries_.begin(); iter != entries_.end(); ++iter) {
+      if (iter->first != keep &&
+          (oldest == entries_.end() || iter->second.last_used < oldest->second.last_used)) {
+        oldest = iter;
+      }
+    }
+    std::error_code error;
+    std::filesystem::remove(directory_ / oldest->first, error);
+    stats_.bytes -= oldest->second.bytes;
+    entries_.erase(oldest);
+    ++stats_.evictions;
+  }
+}
+
+}  // namespace vita::ui
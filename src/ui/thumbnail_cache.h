@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace vita::ui {
+
+// Persistent cache of artwork already scaled to the size it is drawn at,
+// stored as raw ARGB8888 rows so a hit is a file read straight into a
+// surface with no decode. Entries are keyed by source path and target size
+// and record the source's size, mtime and content hash; a changed mtime
+// alone falls back to comparing the hash. The directory is capped at
+// `capacity_bytes`, evicting least recently used files first (file mtimes
+// carry the order across runs). Safe to call from several threads.
+class ThumbnailCache {
+ public:
+  static constexpr uintmax_t kDefaultCapacityBytes = 64 * 1024 * 1024;
+
+  struct Stats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t stores = 0;
+    uint64_t evictions = 0;
+    uintmax_t bytes = 0;
+    size_t entries = 0;
+  };
+
+  // What a thumbnail was made from. Fill it from the very bytes that were
+  // decoded, with the mtime read before they were, so artwork replaced
+  // mid-decode is never recorded under the new file's identity.
+  struct Source {
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    uint64_t hash = 0;
+  };
+
+  // `path`'s mtime as Source records it; 0 when it cannot be read.
+  static int64_t SourceMtime(const std::filesystem::path &path);
+
+  explicit ThumbnailCache(std::filesystem::path directory,
+                          uintmax_t capacity_bytes = kDefaultCapacityBytes);
+
+  // Copies the cached width x height thumbnail of `source` into `pixels`
+  // (rows `pitch` bytes apart). False when missing or stale.
+  bool Load(const std::filesystem::path &source, int width, int height, void *pixels,
+            size_t pitch);
+  // Stores tightly packed ARGB8888 `pixels` for `source` at width x height,
+  // decoded from the file described by `origin`.
+  bool Store(const std::filesystem::path &source, const Source &origin, int width, int height,
+             std::string_view pixels);
+  Stats stats() const;
+
+ private:
+  struct Entry {
+    uintmax_t bytes = 0;
+    uint64_t last_used = 0;
+  };
+
+  std::filesystem::path directory_;
+  uintmax_t capacity_;
+
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, Entry> entries_;  // by file name
+  uint64_t use_clock_ = 0;
+  Stats stats_;
+
+  std::string FileName(const std::filesystem::path &source, int width, int height) const;
+  void Touch(const std::string &name, uintmax_t bytes);
+  void EvictLocked(const std::string &keep);
+};
+
+}  // namespace vita::ui